@@ -0,0 +1,30 @@
+#include "Barrier.h"
+
+namespace ucxx {
+
+Barrier::Barrier(unsigned count)
+    : m_count(count > 0 ? count : 1),
+      m_arrived(0),
+      m_round(0)
+{
+}
+
+bool Barrier::wait()
+{
+    MutexLocker locker(&m_mutex);
+    unsigned round = m_round;
+    if (++m_arrived == m_count) {
+        m_arrived = 0;
+        m_round++;
+        m_cond.notifyAll();
+        return true;
+    }
+
+    // The round number protects against spurious wake-ups
+    while (round == m_round) {
+        m_cond.wait(&m_mutex);
+    }
+    return false;
+}
+
+} // namespace ucxx
@@ -0,0 +1,56 @@
+#ifndef UCXX_BARRIER_H
+#define UCXX_BARRIER_H
+
+//
+// Reusable thread barrier
+//
+
+#include "Mutex.h"
+#include "ConditionVariable.h"
+
+namespace ucxx {
+
+/**
+ * @brief Barrier for a fixed number of threads.
+ * Each thread calling wait() blocks until all of them have arrived, then
+ * all are released and the barrier is ready for the next round, e.g. the
+ * next phase of a stepped computation.
+ */
+class Barrier
+{
+public:
+
+    /**
+     * @brief Construct a barrier.
+     * @param count Number of threads meeting at the barrier, at least one.
+     */
+    explicit Barrier(unsigned count);
+
+    /**
+     * @brief Wait for all threads to arrive.
+     * @return true in exactly one thread of each round (the last one to
+     * arrive), which may e.g. do serial work between phases.
+     */
+    bool wait();
+
+    /**
+     * @brief Returns number of threads meeting at the barrier.
+     */
+    unsigned count() const { return m_count; }
+
+private:
+
+    // Disable copying
+    Barrier(const Barrier&);
+    Barrier& operator =(const Barrier&);
+
+    Mutex m_mutex;                  ///< Protects the state.
+    ConditionVariable m_cond;       ///< Waiting threads sleep here.
+    const unsigned m_count;         ///< Number of threads per round.
+    unsigned m_arrived;             ///< Threads arrived in the current round.
+    unsigned m_round;               ///< Round number, tells rounds apart.
+};
+
+} // namespace ucxx
+
+#endif // UCXX_BARRIER_H
@@ -56,7 +56,7 @@ void ByteArray::append(const ByteArray &ba)
 
 void ByteArray::append(const char *pBuffer, size_t size)
 {
-	std::copy(&pBuffer[0], &pBuffer[size], std::back_inserter(m_data));
+    m_data.insert(m_data.end(), pBuffer, pBuffer + size);
 }
 
 void ByteArray::append(const std::string &str)
@@ -64,6 +64,11 @@ void ByteArray::append(const std::string &str)
     append(str.c_str(), str.length());
 }
 
+void ByteArray::resize(size_t size)
+{
+    m_data.resize(size);
+}
+
 void ByteArray::clear()
 {
     m_data.clear();
@@ -94,6 +94,13 @@ public:
      */
     void append(const std::string &str);
 
+    /**
+     * @brief Change the size of this byte array.
+     * New bytes, if any, are set to zero. Shrinking keeps the allocated memory.
+     * @param size New size.
+     */
+    void resize(size_t size);
+
     /**
      * @brief Remove all data from this byte array.
      * @post Byte array resulting size is set to zero.
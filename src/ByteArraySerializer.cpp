@@ -1,62 +1,240 @@
+#include <string.h>
+#include <iterator>
+#include "Endian.h"
+#include "WireFormat.h"
+#include "Parallel.h"
 #include "ByteArraySerializer.h"
 
 namespace ucxx {
 
-const char cTypeSignature[Variant::MaxTypes] = {
-    'X',    // Invalid
-	'N',	// Null
-    'B',    // Boolean
-    'I',    // Integer
-    'R',    // Real
-    'S',    // String
-    'L',    // List
-    'M'     // Map
-};
-
-std::map<char, Variant::Type> createSignatureToTypeMap()
-{
-	std::map<char, Variant::Type> map;
-	map['X'] = Variant::Type_Invalid;
-	map['N'] = Variant::Type_Null;
-	map['B'] = Variant::Type_Boolean;
-	map['I'] = Variant::Type_Integer;
-	map['R'] = Variant::Type_Real;
-	map['S'] = Variant::Type_String;
-	map['L'] = Variant::Type_List;
-	map['M'] = Variant::Type_Map;
-	return map;
-}
-const std::map<char, Variant::Type> cSignatureToTypeMap = createSignatureToTypeMap();
-
+// Raw values are stored in little-endian byte order at any (unaligned) offset.
 template <typename T>
 void pushRawValue(T value, ByteArray &byteArray)
 {
 	char buffer[sizeof(T)];
-	T *pValue = reinterpret_cast<T*>(buffer);
-	*pValue = value;
+	storeLittleEndian<T>(buffer, value);
 	byteArray.append(buffer, sizeof(T));
 }
 
 template <typename T>
-bool popRawValue(const ByteArray &byteArray, unsigned &index, T &value)
+bool popRawValue(const char *pData, size_t size, unsigned &index, T &value)
 {
-	if (byteArray.size() - index < sizeof(T)) {
+	if (size - index < sizeof(T)) {
 		return false;
 	}
-	const char *pBuffer = byteArray.constData() + index;
-	value = *reinterpret_cast<const T*>(pBuffer);
+	value = loadLittleEndian<T>(pData + index);
 	index += sizeof(T);
 	return true;
 }
 
+namespace {
+
+/*
+ * Parallel processing of large containers.
+ * Each chunk of elements is encoded into (or decoded from) its own
+ * serializer, the chunks run on ThreadPool::global() via parallelChunks()
+ * with the calling thread taking part.
+ */
+
+void pushElement(ByteArraySerializer &serializer, const Variant &value)
+{
+	serializer.pushValue(value);
+}
+
+void pushElement(ByteArraySerializer &serializer, const VariantMap::value_type &entry)
+{
+	serializer.pushKey(entry.first.data(), entry.first.length());
+	serializer.pushValue(entry.second);
+}
+
+bool popElement(ByteArraySerializer &serializer, VariantList &list)
+{
+	list.push_back(Variant());
+	return serializer.popValue(list.back());
+}
+
+bool popElement(ByteArraySerializer &serializer, VariantMap &map)
+{
+	std::string key;
+	if (!serializer.popKey(key)) {
+		return false;
+	}
+	return serializer.popValue(map[key]);
+}
+
+void appendChunk(VariantList &list, VariantList &chunk)
+{
+	list.splice(list.end(), chunk);
+}
+
+void appendChunk(VariantMap &map, VariantMap &chunk)
+{
+	// Keys arrive in order, so hinted insertion at the end is constant time
+	for (VariantMap::iterator it = chunk.begin(); it != chunk.end(); ++it) {
+		VariantMap::iterator pos = map.insert(map.end(), VariantMap::value_type(it->first, Variant()));
+		pos->second.swap(it->second);
+	}
+}
+
+template <typename Container>
+class ChunkEncoder : public IRunnable
+{
+public:
+	ChunkEncoder(typename Container::const_iterator first, typename Container::const_iterator last)
+		: m_first(first), m_last(last) {}
+
+	void run()
+	{
+		for (typename Container::const_iterator it = m_first; it != m_last; ++it) {
+			pushElement(m_serializer, *it);
+		}
+	}
+
+	const ByteArray& byteArray() const { return m_serializer.byteArray(); }
+
+private:
+	typename Container::const_iterator m_first;
+	typename Container::const_iterator m_last;
+	ByteArraySerializer m_serializer;
+};
+
+template <typename Container>
+class ChunkDecoder : public IRunnable
+{
+public:
+	ChunkDecoder(const char *pData, size_t size, unsigned count)
+		: m_count(count), m_ok(false)
+	{
+		m_serializer.attach(pData, size);
+	}
+
+	void run()
+	{
+		for (unsigned i = 0; i < m_count; i++) {
+			if (!popElement(m_serializer, m_value)) {
+				return;
+			}
+		}
+		m_ok = m_serializer.available() == 0;
+	}
+
+	bool isOk() const { return m_ok; }
+	Container& value() { return m_value; }
+
+private:
+	unsigned m_count;
+	bool m_ok;
+	Container m_value;
+	ByteArraySerializer m_serializer;
+};
+
+// Run the tasks on the shared pool, the calling thread taking part.
+// Every task runs (inline if the pool is busy), none is left out.
+template <typename Task>
+void runTasks(std::vector<Task*> &tasks)
+{
+	parallelChunks(tasks.size(), [&tasks](size_t i) {
+		tasks[i]->run();
+	});
+}
+
+bool skipBytes(size_t size, unsigned &index, size_t count)
+{
+	if (size - index < count) {
+		return false;
+	}
+	index += count;
+	return true;
+}
+
+bool skipString(const char *pData, size_t size, unsigned &index)
+{
+	unsigned length = 0;
+	return popRawValue<unsigned>(pData, size, index, length) && skipBytes(size, index, length);
+}
+
+/*
+ * Find the end of an encoded value without decoding it.
+ * Dictionary keys are not accepted, they cannot be resolved out of order.
+ */
+bool skipValue(const char *pData, size_t size, unsigned &index)
+{
+	Variant::Type type = Variant::Type_Invalid;
+	if (index >= size || !signatureType(pData[index], type)) {
+		return false;
+	}
+	++index;
+
+	switch (type) {
+	case Variant::Type_Boolean:
+		return skipBytes(size, index, sizeof(bool));
+	case Variant::Type_Integer:
+		return skipBytes(size, index, sizeof(int));
+	case Variant::Type_Real:
+		return skipBytes(size, index, sizeof(double));
+	case Variant::Type_String:
+		return skipString(pData, size, index);
+	case Variant::Type_List:
+	case Variant::Type_Map: {
+		unsigned length = 0;
+		if (!popRawValue<unsigned>(pData, size, index, length)) {
+			return false;
+		}
+		for (unsigned i = 0; i < length; i++) {
+			if (type == Variant::Type_Map) {
+				if (index >= size || pData[index] != typeSignature(Variant::Type_String)) {
+					return false;
+				}
+				++index;
+				if (!skipString(pData, size, index)) {
+					return false;
+				}
+			}
+			if (!skipValue(pData, size, index)) {
+				return false;
+			}
+		}
+		return true;
+	}
+	default:
+		return true;
+	}
+}
+
+bool skipElement(const char *pData, size_t size, unsigned &index, const VariantList*)
+{
+	return skipValue(pData, size, index);
+}
+
+bool skipElement(const char *pData, size_t size, unsigned &index, const VariantMap*)
+{
+	if (index >= size || pData[index] != typeSignature(Variant::Type_String)) {
+		return false;
+	}
+	++index;
+	return skipString(pData, size, index) && skipValue(pData, size, index);
+}
+
+} // namespace
+
 ByteArraySerializer::ByteArraySerializer()
-    : m_byteArray()
+    : m_byteArray(),
+      m_pView(0),
+      m_viewSize(0),
+      m_keyDictionaryEnabled(false),
+      m_threadCount(0),
+      m_valueReuseEnabled(false)
 {
     reset();
 }
 
 ByteArraySerializer::ByteArraySerializer(const ByteArray &ba)
-    : m_byteArray(ba)
+    : m_byteArray(ba),
+      m_pView(0),
+      m_viewSize(0),
+      m_keyDictionaryEnabled(false),
+      m_threadCount(0),
+      m_valueReuseEnabled(false)
 {
     reset();
 }
@@ -64,12 +242,31 @@ ByteArraySerializer::ByteArraySerializer(const ByteArray &ba)
 void ByteArraySerializer::initWith(const ByteArray &ba)
 {
 	m_byteArray = ba;
+	m_pView = 0;
+	m_viewSize = 0;
 	reset();
 }
 
+void ByteArraySerializer::attach(const char *pData, size_t size)
+{
+	m_byteArray.clear();
+	m_pView = pData;
+	m_viewSize = size;
+	reset();
+}
+
+void ByteArraySerializer::detach()
+{
+	if (m_pView != 0) {
+		m_byteArray = ByteArray(m_pView, m_viewSize);
+		m_pView = 0;
+		m_viewSize = 0;
+	}
+}
+
 size_t ByteArraySerializer::available() const
 {
-    return m_byteArray.size() - m_index;
+    return readSize() - m_index;
 }
 
 void ByteArraySerializer::pushValue(const Variant &value)
@@ -104,6 +301,31 @@ void ByteArraySerializer::pushValue(const Variant &value)
 }
 
 bool ByteArraySerializer::popValue(Variant &value)
+{
+    // Incomplete or invalid value must not be partially consumed
+    unsigned index = m_index;
+    bool ok;
+    if (m_valueReuseEnabled) {
+        ok = decodeValue(value);
+    } else {
+        Variant v;
+        ok = decodeValue(v);
+        if (ok) {
+            value.swap(v);
+        }
+    }
+    if (!ok) {
+        m_index = index;
+    }
+    return ok;
+}
+
+/*
+ * Decode into the existing value.
+ * Storage of a value of the same type (string capacity, list nodes,
+ * map entries) is reused, a value of another type is replaced.
+ */
+bool ByteArraySerializer::decodeValue(Variant &value)
 {
     if (available() <= 0) {
         return false;
@@ -115,16 +337,18 @@ bool ByteArraySerializer::popValue(Variant &value)
     	return false;
     }
 
+    if (value.type() != type) {
+    	Variant v(type);
+    	value.swap(v);
+    }
+
     switch (type) {
     case Variant::Type_Invalid:
-    	value = Variant(Variant::Type_Invalid);
-    	break;
     case Variant::Type_Null:
-    	value = Variant(Variant::Type_Null);
     	break;
     case Variant::Type_Boolean: {
     	bool v;
-    	if (!popBoolean(v)) {
+    	if (!popRawValue<bool>(readData(), readSize(), m_index, v)) {
     		return false;
     	}
     	value = v;
@@ -132,7 +356,7 @@ bool ByteArraySerializer::popValue(Variant &value)
     }
     case Variant::Type_Integer: {
     	int v;
-    	if (!popInteger(v)) {
+    	if (!popRawValue<int>(readData(), readSize(), m_index, v)) {
     		return false;
     	}
     	value = v;
@@ -140,36 +364,18 @@ bool ByteArraySerializer::popValue(Variant &value)
     }
     case Variant::Type_Real: {
     	double v;
-    	if (!popReal(v)) {
-    		return false;
-    	}
-    	value = v;
-    	break;
-    }
-    case Variant::Type_String: {
-    	std::string v;
-    	if (!popString(v)) {
-    		return false;
-    	}
-    	value = v;
-    	break;
-    }
-    case Variant::Type_List: {
-    	VariantList v;
-    	if (!popList(v)) {
-    		return false;
-    	}
-    	value = v;
-    	break;
-    }
-    case Variant::Type_Map: {
-    	VariantMap v;
-    	if (!popMap(v)) {
+    	if (!popRawValue<double>(readData(), readSize(), m_index, v)) {
     		return false;
     	}
     	value = v;
     	break;
     }
+    case Variant::Type_String:
+    	return popStringData(value.string());
+    case Variant::Type_List:
+    	return popListData(value.list());
+    case Variant::Type_Map:
+    	return popMapData(value.map());
     default:
     	return false;
     }
@@ -182,9 +388,24 @@ void ByteArraySerializer::reset()
     m_index = 0;
 }
 
+void ByteArraySerializer::clearKeyDictionary()
+{
+    m_keyIds.clear();
+    m_keys.clear();
+}
+
+void ByteArraySerializer::seek(unsigned index)
+{
+    m_index = index < readSize() ? index : readSize();
+}
+
 void ByteArraySerializer::pushTypeSignature(Variant::Type type)
 {
-	m_byteArray.append(cTypeSignature[type]);
+	// Every push starts here, so this is where an attached view gets copied
+	if (m_pView != 0) {
+		detach();
+	}
+	m_byteArray.append(typeSignature(type));
 }
 
 bool ByteArraySerializer::popTypeSignature(Variant::Type &type)
@@ -193,18 +414,30 @@ bool ByteArraySerializer::popTypeSignature(Variant::Type &type)
 		return false;
 	}
 
-	char c = m_byteArray.constData()[m_index];
-	std::map<char, Variant::Type>::const_iterator it = cSignatureToTypeMap.find(c);
-	if (it == cSignatureToTypeMap.end()) {
+	char c = readData()[m_index];
+	if (!signatureType(c, type)) {
 		// Invalid signature
 		return false;
 	}
 
-	type = it->second;
 	++m_index;
 	return true;
 }
 
+bool ByteArraySerializer::popTypeSignature(Variant::Type expected, unsigned &index)
+{
+	index = m_index;
+	Variant::Type type = Variant::Type_Invalid;
+	if (!popTypeSignature(type)) {
+		return false;
+	}
+	if (type != expected) {
+		m_index = index;
+		return false;
+	}
+	return true;
+}
+
 void ByteArraySerializer::pushInvalid()
 {
 	pushTypeSignature(Variant::Type_Invalid);
@@ -234,18 +467,71 @@ void ByteArraySerializer::pushReal(double value)
 }
 
 void ByteArraySerializer::pushString(const std::string &value)
+{
+	pushString(value.c_str(), value.length());
+}
+
+void ByteArraySerializer::pushString(const char *pValue, size_t length)
 {
 	pushTypeSignature(Variant::Type_String);
-	unsigned length = value.length();
 	pushRawValue<unsigned>(length, m_byteArray);
-	m_byteArray.append(value.c_str(), length);
+	m_byteArray.append(pValue, length);
 }
 
-void ByteArraySerializer::pushList(const VariantList &value)
+void ByteArraySerializer::pushListHeader(unsigned size)
 {
 	pushTypeSignature(Variant::Type_List);
-	unsigned size = value.size();
 	pushRawValue<unsigned>(size, m_byteArray);
+}
+
+void ByteArraySerializer::pushMapHeader(unsigned size)
+{
+	pushTypeSignature(Variant::Type_Map);
+	pushRawValue<unsigned>(size, m_byteArray);
+}
+
+void ByteArraySerializer::pushKey(const char *pKey, size_t length)
+{
+	if (!m_keyDictionaryEnabled) {
+		pushString(pKey, length);
+		return;
+	}
+
+	std::string key(pKey, length);
+	std::unordered_map<std::string, unsigned>::const_iterator it = m_keyIds.find(key);
+	if (it != m_keyIds.end()) {
+		if (m_pView != 0) {
+			detach();
+		}
+		m_byteArray.append(cKeyReferenceSignature);
+		pushRawValue<uint16_t>(it->second, m_byteArray);
+		return;
+	}
+
+	if (m_keyIds.size() >= cMaxKeyDictionarySize) {
+		// Dictionary is full
+		pushString(pKey, length);
+		return;
+	}
+
+	unsigned id = m_keyIds.size();
+	m_keyIds[key] = id;
+	if (m_pView != 0) {
+		detach();
+	}
+	m_byteArray.append(cKeyDefinitionSignature);
+	pushRawValue<uint16_t>(id, m_byteArray);
+	pushRawValue<unsigned>(length, m_byteArray);
+	m_byteArray.append(pKey, length);
+}
+
+void ByteArraySerializer::pushList(const VariantList &value)
+{
+	pushListHeader(value.size());
+	if (isParallel(value.size()) && !m_keyDictionaryEnabled) {
+		pushParallel(value);
+		return;
+	}
 	for (VariantList::const_iterator it = value.begin(); it != value.end(); ++it) {
 		pushValue(*it);
 	}
@@ -253,34 +539,135 @@ void ByteArraySerializer::pushList(const VariantList &value)
 
 void ByteArraySerializer::pushMap(const VariantMap &value)
 {
-	pushTypeSignature(Variant::Type_Map);
-	unsigned size = value.size();
-	pushRawValue<unsigned>(size, m_byteArray);
+	pushMapHeader(value.size());
+	if (isParallel(value.size()) && !m_keyDictionaryEnabled) {
+		pushParallel(value);
+		return;
+	}
 	for (VariantMap::const_iterator it = value.begin(); it != value.end(); ++it) {
-		pushValue(Variant(it->first));
+		pushKey(it->first.c_str(), it->first.length());
 		pushValue(it->second);
 	}
 }
 
 bool ByteArraySerializer::popBoolean(bool &value)
 {
-	return popRawValue<bool>(m_byteArray, m_index, value);
+	unsigned index;
+	if (!popTypeSignature(Variant::Type_Boolean, index)) {
+		return false;
+	}
+	if (!popRawValue<bool>(readData(), readSize(), m_index, value)) {
+		m_index = index;
+		return false;
+	}
+	return true;
 }
 
 bool ByteArraySerializer::popInteger(int &value)
 {
-	return popRawValue<int>(m_byteArray, m_index, value);
+	unsigned index;
+	if (!popTypeSignature(Variant::Type_Integer, index)) {
+		return false;
+	}
+	if (!popRawValue<int>(readData(), readSize(), m_index, value)) {
+		m_index = index;
+		return false;
+	}
+	return true;
 }
 
 bool ByteArraySerializer::popReal(double &value)
 {
-	return popRawValue<double>(m_byteArray, m_index, value);
+	unsigned index;
+	if (!popTypeSignature(Variant::Type_Real, index)) {
+		return false;
+	}
+	if (!popRawValue<double>(readData(), readSize(), m_index, value)) {
+		m_index = index;
+		return false;
+	}
+	return true;
 }
 
 bool ByteArraySerializer::popString(std::string &value)
+{
+	unsigned index;
+	if (!popTypeSignature(Variant::Type_String, index)) {
+		return false;
+	}
+	if (!popStringData(value)) {
+		m_index = index;
+		return false;
+	}
+	return true;
+}
+
+bool ByteArraySerializer::popListHeader(unsigned &size)
+{
+	unsigned index;
+	if (!popTypeSignature(Variant::Type_List, index)) {
+		return false;
+	}
+	if (!popRawValue<unsigned>(readData(), readSize(), m_index, size)) {
+		m_index = index;
+		return false;
+	}
+	return true;
+}
+
+bool ByteArraySerializer::popMapHeader(unsigned &size)
+{
+	unsigned index;
+	if (!popTypeSignature(Variant::Type_Map, index)) {
+		return false;
+	}
+	if (!popRawValue<unsigned>(readData(), readSize(), m_index, size)) {
+		m_index = index;
+		return false;
+	}
+	return true;
+}
+
+bool ByteArraySerializer::popKey(std::string &key)
+{
+	if (available() < 1) {
+		return false;
+	}
+
+	unsigned index = m_index;
+	char c = readData()[m_index];
+	if (c == cKeyReferenceSignature) {
+		++m_index;
+		uint16_t id = 0;
+		if (!popRawValue<uint16_t>(readData(), readSize(), m_index, id) || id >= m_keys.size()) {
+			m_index = index;
+			return false;
+		}
+		key = m_keys[id];
+		return true;
+	}
+
+	if (c == cKeyDefinitionSignature) {
+		++m_index;
+		uint16_t id = 0;
+		if (!popRawValue<uint16_t>(readData(), readSize(), m_index, id) || !popStringData(key)) {
+			m_index = index;
+			return false;
+		}
+		if (id >= m_keys.size()) {
+			m_keys.resize(id + 1);
+		}
+		m_keys[id] = key;
+		return true;
+	}
+
+	return popString(key);
+}
+
+bool ByteArraySerializer::popStringData(std::string &value)
 {
 	unsigned length = 0;
-	if (!popRawValue<unsigned>(m_byteArray, m_index, length)) {
+	if (!popRawValue<unsigned>(readData(), readSize(), m_index, length)) {
 		return false;
 	}
 
@@ -288,54 +675,152 @@ bool ByteArraySerializer::popString(std::string &value)
 		return false;
 	}
 
-	value = std::string(m_byteArray.constData() + m_index, length);
+	value.assign(readData() + m_index, length);
 	m_index += length;
 	return true;
 }
 
-bool ByteArraySerializer::popList(VariantList &value)
+bool ByteArraySerializer::popListData(VariantList &value)
 {
 	unsigned length = 0;
-	if (!popRawValue<unsigned>(m_byteArray, m_index, length)) {
+	if (!popRawValue<unsigned>(readData(), readSize(), m_index, length)) {
 		return false;
 	}
 
-	VariantList list;
+	if (isParallel(length) && popParallel(length, value)) {
+		return true;
+	}
+
+	// Overwrite existing elements, drop the surplus ones
+	VariantList::iterator it = value.begin();
 	for (unsigned i = 0; i < length; i++) {
-		Variant v;
-		if (!popValue(v)) {
+		if (it == value.end()) {
+			it = value.insert(it, Variant());
+		}
+		if (!decodeValue(*it)) {
 			return false;
 		}
-		list.push_back(v);
+		++it;
 	}
-	value = list;
+	value.erase(it, value.end());
 	return true;
 }
 
-bool ByteArraySerializer::popMap(VariantMap &value)
+bool ByteArraySerializer::popMapData(VariantMap &value)
 {
 	unsigned length = 0;
-	if (!popRawValue<unsigned>(m_byteArray, m_index, length)) {
+	if (!popRawValue<unsigned>(readData(), readSize(), m_index, length)) {
 		return false;
 	}
 
-	VariantMap map;
+	if (isParallel(length) && popParallel(length, value)) {
+		return true;
+	}
+
+	// Keys normally arrive in order: walk the existing entries along,
+	// reusing matching ones and dropping those not present any more.
+	VariantMap::iterator it = value.begin();
 	for (unsigned i = 0; i < length; i++) {
-		Variant key;
-		if (!popValue(key)) {
+		if (!popKey(m_key)) {
 			return false;
 		}
-		if (key.type() != Variant::Type_String) {
+		if (it != value.begin() && !(std::prev(it)->first < m_key)) {
+			// Out of order or repeated key
+			if (!decodeValue(value[m_key])) {
+				return false;
+			}
+			continue;
+		}
+		while (it != value.end() && it->first < m_key) {
+			value.erase(it++);
+		}
+		if (it == value.end() || it->first != m_key) {
+			it = value.insert(it, VariantMap::value_type(m_key, Variant()));
+		}
+		if (!decodeValue(it->second)) {
 			return false;
 		}
-		Variant v;
-		if (!popValue(v)) {
+		++it;
+	}
+	value.erase(it, value.end());
+	return true;
+}
+
+bool ByteArraySerializer::isParallel(size_t size) const
+{
+	return m_threadCount > 1 && size >= ParallelThreshold;
+}
+
+template <typename Container>
+void ByteArraySerializer::pushParallel(const Container &value)
+{
+	size_t chunkSize = (value.size() + m_threadCount - 1) / m_threadCount;
+	std::vector<ChunkEncoder<Container>*> encoders;
+	typename Container::const_iterator first = value.begin();
+	for (size_t remaining = value.size(); remaining > 0; ) {
+		size_t count = remaining < chunkSize ? remaining : chunkSize;
+		typename Container::const_iterator last = first;
+		std::advance(last, count);
+		encoders.push_back(new ChunkEncoder<Container>(first, last));
+		first = last;
+		remaining -= count;
+	}
+
+	runTasks(encoders);
+
+	size_t size = m_byteArray.size();
+	for (size_t i = 0; i < encoders.size(); i++) {
+		size += encoders[i]->byteArray().size();
+	}
+	size_t offset = m_byteArray.size();
+	m_byteArray.resize(size);
+	for (size_t i = 0; i < encoders.size(); i++) {
+		const ByteArray &chunk = encoders[i]->byteArray();
+		memcpy(m_byteArray.data() + offset, chunk.constData(), chunk.size());
+		offset += chunk.size();
+		delete encoders[i];
+	}
+}
+
+template <typename Container>
+bool ByteArraySerializer::popParallel(unsigned length, Container &value)
+{
+	// Find chunk boundaries, any irregularity is left to the sequential decoder
+	unsigned chunkSize = (length + m_threadCount - 1) / m_threadCount;
+	std::vector<unsigned> bounds(1, m_index);
+	unsigned index = m_index;
+	for (unsigned i = 0; i < length; i++) {
+		if (!skipElement(readData(), readSize(), index, &value)) {
 			return false;
 		}
-		map[key.string()] = v;
+		if ((i + 1) % chunkSize == 0 || i + 1 == length) {
+			bounds.push_back(index);
+		}
+	}
+
+	std::vector<ChunkDecoder<Container>*> decoders;
+	for (size_t i = 0; i + 1 < bounds.size(); i++) {
+		unsigned count = i + 2 < bounds.size() ? chunkSize : length - i * chunkSize;
+		decoders.push_back(new ChunkDecoder<Container>(readData() + bounds[i], bounds[i + 1] - bounds[i], count));
+	}
+
+	runTasks(decoders);
+
+	bool ok = true;
+	Container result;
+	for (size_t i = 0; i < decoders.size(); i++) {
+		ok = ok && decoders[i]->isOk();
+		if (ok) {
+			appendChunk(result, decoders[i]->value());
+		}
+		delete decoders[i];
+	}
+	if (!ok) {
+		return false;
 	}
 
-	value = map;
+	value.swap(result);
+	m_index = index;
 	return true;
 }
 
@@ -5,6 +5,8 @@
 // Variant serializer into a byte array
 //
 
+#include <vector>
+#include <unordered_map>
 #include "IVariantSerializer.h"
 #include "ByteArray.h"
 
@@ -13,6 +15,8 @@ namespace ucxx {
 /**
  * Implementation of IVariantSerializer interface.
  * Data is serialized into a byte array.
+ * Numeric values are always encoded in little-endian byte order,
+ * so the serialized data can be exchanged between hosts of different endianness.
  */
 class ByteArraySerializer : public IVariantSerializer
 {
@@ -22,40 +26,178 @@ public:
 
     void initWith(const ByteArray &ba);
 
+    /**
+     * @brief Decode from an external buffer without copying it.
+     * The buffer must stay valid and unmodified while values are being
+     * popped. Pushing a value copies the buffer into the internal byte
+     * array first, after which the external buffer is no longer referenced.
+     * @param pData Encoded data.
+     * @param size Number of bytes.
+     */
+    void attach(const char *pData, size_t size);
+
     size_t available() const;
 
     // IVariantSerializer interface
     void pushValue(const Variant &value);
+
+    /**
+     * @brief Decode next value.
+     * If the buffer ends in the middle of the value the read index is left
+     * unchanged. Use VariantDecoder to decode data arriving in chunks.
+     * @param v Decoded value.
+     * @return false if there is no complete value or the data is invalid.
+     */
     bool popValue(Variant &v);
 
     // Reset read index to zero.
     void reset();
 
+    /**
+     * @brief Enable or disable the map key dictionary for encoding.
+     * With the dictionary enabled each distinct map key is written in full
+     * only the first time it is seen, later occurrences refer to it by a
+     * small integer id. Decoding always understands dictionary keys,
+     * the decoder mirrors the dictionary as it reads key definitions.
+     * The dictionary is kept for the lifetime of the serializer (including
+     * initWith() calls), so it spans a whole stream of messages.
+     * @param enabled true to enable the dictionary.
+     */
+    void setKeyDictionaryEnabled(bool enabled) { m_keyDictionaryEnabled = enabled; }
+    bool isKeyDictionaryEnabled() const { return m_keyDictionaryEnabled; }
+
+    /**
+     * @brief Forget all keys of both encoding and decoding dictionaries.
+     * Used when starting a new stream.
+     */
+    void clearKeyDictionary();
+
+    /**
+     * @brief Enable or disable decoding into the existing value.
+     * By default popValue() replaces the value with a newly built one.
+     * With reuse enabled the decoded data overwrites the value in place
+     * wherever the types match: strings keep their capacity, list elements
+     * and map entries with the same key are reused, so decoding a stream of
+     * messages of the same shape into the same variant does not allocate.
+     * If popValue() fails the value is left in an unspecified state.
+     * Containers decoded in parallel (see setThreadCount()) are rebuilt.
+     * @param enabled true to reuse the value.
+     */
+    void setValueReuseEnabled(bool enabled) { m_valueReuseEnabled = enabled; }
+    bool isValueReuseEnabled() const { return m_valueReuseEnabled; }
+
+    /**
+     * @brief Set number of threads used for large lists and maps.
+     * A list or map of at least ParallelThreshold elements is split into one
+     * chunk per thread, the chunks run on ThreadPool::global() with the
+     * calling thread taking part. Encoding produces the chunks independently
+     * and concatenates them, so the result is byte-identical to sequential
+     * encoding. Decoding first scans the container for chunk boundaries
+     * without constructing any values, then decodes the chunks in parallel.
+     * Containers are processed sequentially while the key dictionary is
+     * involved, as dictionary keys make the chunks interdependent.
+     * @param count Number of threads, 0 or 1 for sequential processing.
+     */
+    void setThreadCount(unsigned count) { m_threadCount = count; }
+    unsigned threadCount() const { return m_threadCount; }
+
+    /// Minimum number of container elements processed in parallel.
+    static const unsigned ParallelThreshold = 16384;
+
+    /**
+     * @brief Returns current read index.
+     */
+    unsigned position() const { return m_index; }
+
+    /**
+     * @brief Move read index to the given position.
+     * @param index New read index, clamped to the data size.
+     */
+    void seek(unsigned index);
+
+    /**
+     * @brief Returns the internal byte array.
+     * @note The array is empty while an external buffer is attached.
+     */
     const ByteArray& byteArray() const { return m_byteArray; }
 
-private:
-
-    void pushTypeSignature(Variant::Type type);
-    bool popTypeSignature(Variant::Type &type);
+    /*
+     * Typed encoding.
+     * These methods write and read single values of a known type without
+     * constructing a Variant (used by Serializer<T>, see StructSerializer.h).
+     * The encoding is identical to pushValue() of the corresponding variant.
+     * Typed pop methods fail without consuming anything if the next
+     * value is of a different type.
+     */
 
-    void pushInvalid();
-    void pushNull();
     void pushBoolean(bool value);
     void pushInteger(int value);
     void pushReal(double value);
     void pushString(const std::string &value);
-    void pushList(const VariantList &value);
-    void pushMap(const VariantMap &value);
+    void pushString(const char *pValue, size_t length);
+
+    /**
+     * @brief Start a list of a given size.
+     * Must be followed by exactly size values.
+     */
+    void pushListHeader(unsigned size);
+
+    /**
+     * @brief Start a map of a given size.
+     * Must be followed by exactly size key/value pairs, each key written with pushKey().
+     */
+    void pushMapHeader(unsigned size);
+
+    /**
+     * @brief Write a map key.
+     * The key is written as a String or, if the key dictionary is enabled,
+     * as a dictionary definition or reference.
+     */
+    void pushKey(const char *pKey, size_t length);
 
     bool popBoolean(bool &value);
     bool popInteger(int &value);
     bool popReal(double &value);
     bool popString(std::string &value);
-    bool popList(VariantList &value);
-    bool popMap(VariantMap &value);
+    bool popListHeader(unsigned &size);
+    bool popMapHeader(unsigned &size);
+    bool popKey(std::string &key);
+
+private:
+
+    void detach();
+    const char* readData() const { return m_pView != 0 ? m_pView : m_byteArray.constData(); }
+    size_t readSize() const { return m_pView != 0 ? m_viewSize : m_byteArray.size(); }
+
+    bool decodeValue(Variant &value);
+
+    void pushTypeSignature(Variant::Type type);
+    bool popTypeSignature(Variant::Type &type);
+    bool popTypeSignature(Variant::Type expected, unsigned &index);
+
+    void pushInvalid();
+    void pushNull();
+    void pushList(const VariantList &value);
+    void pushMap(const VariantMap &value);
+
+    bool popStringData(std::string &value);
+    bool popListData(VariantList &value);
+    bool popMapData(VariantMap &value);
+
+    bool isParallel(size_t size) const;
+    template <typename Container> void pushParallel(const Container &value);
+    template <typename Container> bool popParallel(unsigned length, Container &value);
 
     ByteArray m_byteArray;	///< Internal byte array serialization buffer.
+    const char *m_pView;	///< Attached external buffer, decoded instead of the byte array.
+    size_t m_viewSize;  	///< Size of the attached buffer.
     unsigned m_index;   	///< Read index.
+    bool m_keyDictionaryEnabled;	///< Encode map keys via the dictionary.
+    std::unordered_map<std::string, unsigned> m_keyIds;	///< Encoding dictionary.
+    std::vector<std::string> m_keys;	///< Decoding dictionary, indexed by id.
+    unsigned m_threadCount;	///< Number of threads for large containers.
+    bool m_valueReuseEnabled;	///< Decode into the existing value.
+    std::string m_key;	///< Map key being decoded.
 };
 
 } // namespace ucxx
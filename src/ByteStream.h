@@ -0,0 +1,57 @@
+#ifndef UCXX_BYTESTREAM_H
+#define UCXX_BYTESTREAM_H
+
+//
+// Interfaces to sequential byte sinks and sources
+//
+
+#include <stdlib.h>
+
+namespace ucxx {
+
+/**
+ * @brief Destination of a byte stream.
+ */
+class IByteSink
+{
+public:
+
+    /**
+     * @brief Write a buffer into the sink.
+     * @param pData Data to be written.
+     * @param size Number of bytes to write.
+     * @return Number of bytes actually written, zero on error.
+     */
+    virtual size_t writeBuffer(const char *pData, size_t size) = 0;
+    virtual ~IByteSink() {}
+};
+
+/**
+ * @brief Origin of a byte stream.
+ */
+class IByteSource
+{
+public:
+
+    /**
+     * @brief Read available data from the source.
+     * @param pBuffer Destination buffer.
+     * @param size Maximum number of bytes to read.
+     * @return Number of bytes actually read, zero on error, end of stream
+     * or timeout.
+     */
+    virtual size_t readBuffer(char *pBuffer, size_t size) = 0;
+
+    /**
+     * @brief Tells whether the last readBuffer() returned zero because
+     * no data arrived in time. The stream is still usable then and reading
+     * can be retried. Sources without a read timeout never time out.
+     */
+    virtual bool isTimedOut() const { return false; }
+
+    virtual ~IByteSource() {}
+};
+
+} // namespace ucxx
+
+#endif // UCXX_BYTESTREAM_H
@@ -0,0 +1,40 @@
+#include "Checksum.h"
+
+namespace ucxx {
+
+/*
+ * Lookup table for reflected polynomial 0xEDB88320.
+ */
+class Crc32Table
+{
+public:
+    Crc32Table()
+    {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+            }
+            m_table[i] = c;
+        }
+    }
+
+    uint32_t operator [](int i) const { return m_table[i]; }
+
+private:
+    uint32_t m_table[256];
+};
+
+static const Crc32Table cCrc32Table;
+
+uint32_t crc32(const char *pData, size_t size, uint32_t crc)
+{
+    const unsigned char *p = reinterpret_cast<const unsigned char*>(pData);
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) {
+        crc = cCrc32Table[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+} // namespace ucxx
@@ -0,0 +1,26 @@
+#ifndef UCXX_CHECKSUM_H
+#define UCXX_CHECKSUM_H
+
+//
+// Data checksum functions
+//
+
+#include <stdint.h>
+#include <stdlib.h>
+
+namespace ucxx {
+
+/**
+ * @brief Compute CRC-32 (IEEE 802.3) checksum.
+ * Checksum of a buffer split into several parts can be computed
+ * by passing the previous result as the initial value.
+ * @param pData Data buffer.
+ * @param size Number of bytes.
+ * @param crc Checksum of the preceding data, zero to start.
+ * @return Checksum value.
+ */
+uint32_t crc32(const char *pData, size_t size, uint32_t crc = 0);
+
+} // namespace ucxx
+
+#endif // UCXX_CHECKSUM_H
@@ -0,0 +1,46 @@
+#ifdef WIN32
+#   include <Windows.h>
+#elif defined __APPLE__
+#   include <mach/mach_time.h>
+#else
+#   include <time.h>
+#endif
+
+#include "Clock.h"
+
+namespace ucxx {
+
+uint64_t Clock::milliseconds()
+{
+    return microseconds() / 1000;
+}
+
+uint64_t Clock::microseconds()
+{
+#ifdef WIN32
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return static_cast<uint64_t>(counter.QuadPart / frequency.QuadPart * 1000000 +
+            counter.QuadPart % frequency.QuadPart * 1000000 / frequency.QuadPart);
+#elif defined __APPLE__
+    static mach_timebase_info_data_t timebase;
+    if (timebase.denom == 0) {
+        mach_timebase_info(&timebase);
+    }
+    return mach_absolute_time() * timebase.numer / timebase.denom / 1000;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+unsigned Clock::remaining(uint64_t deadline)
+{
+    uint64_t now = milliseconds();
+    return now < deadline ? static_cast<unsigned>(deadline - now) : 0;
+}
+
+} // namespace ucxx
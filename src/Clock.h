@@ -0,0 +1,41 @@
+#ifndef UCXX_CLOCK_H
+#define UCXX_CLOCK_H
+
+//
+// Monotonic clock
+//
+
+#include <stdint.h>
+
+namespace ucxx {
+
+/**
+ * @brief Monotonic time source for timeouts and measurements.
+ * The time is counted from an unspecified starting point and is not
+ * affected by changes of the system (wall-clock) time.
+ */
+class Clock
+{
+public:
+
+    /**
+     * @brief Returns monotonic time in milliseconds.
+     */
+    static uint64_t milliseconds();
+
+    /**
+     * @brief Returns monotonic time in microseconds.
+     */
+    static uint64_t microseconds();
+
+    /**
+     * @brief Returns milliseconds left until a deadline.
+     * @param deadline Deadline in milliseconds() time.
+     * @return Remaining time, zero if the deadline has passed.
+     */
+    static unsigned remaining(uint64_t deadline);
+};
+
+} // namespace ucxx
+
+#endif // UCXX_CLOCK_H
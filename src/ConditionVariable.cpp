@@ -0,0 +1,123 @@
+#ifndef WIN32
+#   include <time.h>
+#   include <errno.h>
+#endif
+
+#include "ConditionVariable.h"
+
+namespace ucxx {
+
+ConditionVariable::ConditionVariable()
+{
+#ifdef WIN32
+    m_waiters.store(0);
+#else
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+#ifndef __APPLE__
+    // Timeouts must not be affected by changes of the system time
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+#endif
+    pthread_cond_init(&m_cond, &attr);
+    pthread_condattr_destroy(&attr);
+#endif
+}
+
+ConditionVariable::~ConditionVariable()
+{
+#ifndef WIN32
+    pthread_cond_destroy(&m_cond);
+#endif
+}
+
+#ifndef WIN32
+inline bool ConditionVariable::waitNative(Mutex *pMutex, unsigned milliseconds)
+{
+    if (milliseconds == 0) {
+        pthread_cond_wait(&m_cond, &pMutex->m_mutex);
+        return true;
+    }
+
+    struct timespec ts;
+#ifdef __APPLE__
+    ts.tv_sec = milliseconds / 1000;
+    ts.tv_nsec = (milliseconds % 1000) * 1000000;
+    int res = pthread_cond_timedwait_relative_np(&m_cond, &pMutex->m_mutex, &ts);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += milliseconds / 1000;
+    ts.tv_nsec += (milliseconds % 1000) * 1000000;
+    ts.tv_sec += ts.tv_nsec / 1000000000;
+    ts.tv_nsec %= 1000000000;
+    int res = pthread_cond_timedwait(&m_cond, &pMutex->m_mutex, &ts);
+#endif
+    return res != ETIMEDOUT;
+}
+#endif
+
+bool ConditionVariable::wait(Mutex *pMutex, unsigned milliseconds)
+{
+#ifdef WIN32
+    // Taking the mutex back is no acquisition, the hold goes on
+#ifdef UCXX_MUTEX_PROFILING
+    uint64_t held = pMutex->suspended();
+#endif
+    m_waiters.fetch_add(1);
+    pMutex->unlockNative();
+    bool notified = m_semaphore.wait(milliseconds);
+    if (!notified) {
+        // Leave unless a notifier has already counted us out,
+        // in which case its notification is on the way.
+        int waiters = m_waiters.load();
+        while (waiters > 0 && !m_waiters.compare_exchange_weak(waiters, waiters - 1)) {
+        }
+        if (waiters == 0) {
+            m_semaphore.wait();
+        }
+    }
+    pMutex->lockNative();
+#ifdef UCXX_MUTEX_PROFILING
+    pMutex->resumed(held);
+#endif
+    return notified;
+#else
+#ifdef UCXX_MUTEX_PROFILING
+    // The mutex is not held while waiting
+    uint64_t held = pMutex->suspended();
+    bool notified = waitNative(pMutex, milliseconds);
+    pMutex->resumed(held);
+    return notified;
+#else
+    return waitNative(pMutex, milliseconds);
+#endif
+#endif
+}
+
+void ConditionVariable::notifyOne()
+{
+#ifdef WIN32
+    int waiters = m_waiters.load();
+    while (waiters > 0) {
+        if (m_waiters.compare_exchange_weak(waiters, waiters - 1)) {
+            m_semaphore.notify();
+            return;
+        }
+    }
+#else
+    pthread_cond_signal(&m_cond);
+#endif
+}
+
+void ConditionVariable::notifyAll()
+{
+#ifdef WIN32
+    int waiters = m_waiters.exchange(0);
+    if (waiters > 0) {
+        m_semaphore.notify(waiters);
+    }
+#else
+    pthread_cond_broadcast(&m_cond);
+#endif
+}
+
+} // namespace ucxx
@@ -0,0 +1,74 @@
+#ifndef UCXX_CONDITIONVARIABLE_H
+#define UCXX_CONDITIONVARIABLE_H
+
+//
+// Platform-specific condition variable implementation
+//
+
+#ifdef WIN32
+#   include <Windows.h>
+#   include <atomic>
+#   include "Sema.h"
+#else
+#   include <pthread.h>
+#endif
+#include "Mutex.h"
+
+namespace ucxx {
+
+/**
+ * @brief Condition variable used with Mutex.
+ * A thread holding a mutex waits for a condition on the protected state,
+ * the mutex being released while waiting; another thread changes the
+ * state and notifies the waiting threads. As with any condition variable
+ * wake-ups may be spurious, so the condition has to be checked in a loop.
+ * @note The mutex must be locked exactly once by the waiting thread,
+ * a recursively locked mutex would not be released while waiting.
+ */
+class ConditionVariable
+{
+public:
+
+    ConditionVariable();
+    ~ConditionVariable();
+
+    /**
+     * @brief Wait for a notification.
+     * @param pMutex Mutex locked by the calling thread, released while
+     * waiting and locked again before returning.
+     * @param milliseconds Waiting timeout, 0 to wait forever.
+     * @return false on timeout.
+     */
+    bool wait(Mutex *pMutex, unsigned milliseconds = 0);
+
+    /**
+     * @brief Wake up one waiting thread.
+     */
+    void notifyOne();
+
+    /**
+     * @brief Wake up all waiting threads.
+     */
+    void notifyAll();
+
+private:
+
+    // Disable copying
+    ConditionVariable(const ConditionVariable&);
+    ConditionVariable& operator =(const ConditionVariable&);
+
+#ifdef WIN32
+    // Windows condition variables do not work with mutex handles,
+    // waiting threads sleep on a semaphore instead.
+    Semaphore m_semaphore;          ///< Waiting threads sleep here.
+    std::atomic<int> m_waiters;     ///< Waiting threads not notified yet.
+#else
+    bool waitNative(Mutex *pMutex, unsigned milliseconds);
+
+    pthread_cond_t m_cond;          ///< System condition variable.
+#endif
+};
+
+} // namespace ucxx
+
+#endif // UCXX_CONDITIONVARIABLE_H
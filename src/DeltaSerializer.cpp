@@ -0,0 +1,118 @@
+#include "VariantDiff.h"
+#include "DeltaSerializer.h"
+
+namespace ucxx {
+
+DeltaSerializer::DeltaSerializer(IVariantSerializer *pSerializer, unsigned keyframeInterval)
+    : m_pSerializer(pSerializer),
+      m_keyframeInterval(keyframeInterval)
+{
+    reset();
+}
+
+void DeltaSerializer::reset()
+{
+    m_sequence = 0;
+    m_sinceKeyframe = 0;
+    m_acknowledged = 0;
+    m_keyframeRequested = false;
+    m_snapshots.clear();
+}
+
+void DeltaSerializer::pushValue(const Variant &value)
+{
+    ++m_sequence;
+
+    Variant frame(Variant::Type_List);
+    VariantList &fields = frame.list();
+    fields.push_back(static_cast<int>(m_sequence));
+
+    // The receiver keeps only recent snapshots, a stale base needs a keyframe
+    SnapshotMap::const_iterator base = m_snapshots.find(m_acknowledged);
+    if (m_keyframeRequested || base == m_snapshots.end() || m_sinceKeyframe >= m_keyframeInterval ||
+            m_sequence - m_acknowledged > m_keyframeInterval) {
+        fields.push_back(Variant(Variant::Type_Null));
+        fields.push_back(value);
+        m_keyframeRequested = false;
+        m_sinceKeyframe = 1;
+    } else {
+        fields.push_back(static_cast<int>(m_acknowledged));
+        fields.push_back(Variant(Variant::Type_List));
+        diffVariants(base->second, value, fields.back().list());
+        ++m_sinceKeyframe;
+    }
+
+    m_pSerializer->pushValue(frame);
+
+    // Keep the snapshot until it is acknowledged or superseded
+    m_snapshots[m_sequence] = value;
+    prune(m_acknowledged);
+}
+
+bool DeltaSerializer::popValue(Variant &value)
+{
+    Variant frame;
+    if (!m_pSerializer->popValue(frame)) {
+        return false;
+    }
+
+    if (frame.type() != Variant::Type_List || frame.list().size() != 3) {
+        return false;
+    }
+    VariantList::const_iterator it = frame.list().begin();
+    const Variant &sequence = *it++;
+    const Variant &base = *it++;
+    const Variant &payload = *it;
+    if (sequence.type() != Variant::Type_Integer) {
+        return false;
+    }
+
+    unsigned current = sequence.toInteger();
+    Variant snapshot;
+    if (base.isNull()) {
+        snapshot = payload;
+        prune(0);
+    } else {
+        SnapshotMap::const_iterator pos = m_snapshots.find(base.toInteger());
+        if (base.type() != Variant::Type_Integer || payload.type() != Variant::Type_List || pos == m_snapshots.end()) {
+            // Unknown base, wait for the next keyframe
+            return false;
+        }
+        snapshot = pos->second;
+        if (!patchVariant(snapshot, payload.list())) {
+            return false;
+        }
+        // The sender will not refer to snapshots older than the base any more
+        prune(pos->first);
+    }
+
+    m_sequence = current;
+    m_snapshots[current] = snapshot;
+    value.swap(snapshot);
+    return true;
+}
+
+void DeltaSerializer::acknowledge(unsigned sequence)
+{
+    // Late acknowledgments and those of dropped snapshots are ignored
+    if (sequence > m_acknowledged && m_snapshots.find(sequence) != m_snapshots.end()) {
+        m_acknowledged = sequence;
+        prune(m_acknowledged);
+    }
+}
+
+void DeltaSerializer::prune(unsigned keep)
+{
+    m_snapshots.erase(m_snapshots.begin(), m_snapshots.lower_bound(keep));
+
+    // Bound the history if acknowledgments do not arrive
+    while (m_snapshots.size() > m_keyframeInterval + 1) {
+        SnapshotMap::iterator oldest = m_snapshots.begin();
+        if (oldest->first == keep) {
+            ++oldest;
+        }
+        m_snapshots.erase(oldest);
+    }
+}
+
+} // namespace ucxx
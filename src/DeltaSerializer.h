@@ -0,0 +1,99 @@
+#ifndef UCXX_DELTASERIALIZER_H
+#define UCXX_DELTASERIALIZER_H
+
+//
+// Delta encoding of consecutive variant snapshots
+//
+
+#include <map>
+#include "IVariantSerializer.h"
+
+namespace ucxx {
+
+/**
+ * @brief Serializer transmitting changes between consecutive snapshots.
+ * Each pushed value is a snapshot of some state. Instead of the full
+ * snapshot, only the changes against the last snapshot acknowledged by the
+ * receiver are sent (see diffVariants()), with a full keyframe sent
+ * periodically and whenever no snapshot is acknowledged yet.
+ * Frames are written into an underlying serializer as lists:
+ *
+ *   [sequence, Null, snapshot]           Keyframe
+ *   [sequence, base sequence, changes]   Delta against the base snapshot
+ *
+ * Sequence numbers start with 1. Acknowledgments travel outside of this
+ * class: the receiver reports sequence() of the snapshots it has decoded
+ * and the sender passes them to acknowledge(). The receiver keeps the
+ * snapshots of the last keyframe interval, a keyframe is sent instead of
+ * a delta when the acknowledged snapshot is older than that.
+ */
+class DeltaSerializer : public IVariantSerializer
+{
+public:
+
+    /// Default number of frames between keyframes.
+    static const unsigned DefaultKeyframeInterval = 50;
+
+    /**
+     * @brief Construct a delta serializer.
+     * @param pSerializer Serializer encoding the frames, not owned.
+     * @param keyframeInterval Send a keyframe at least every given number of frames.
+     */
+    DeltaSerializer(IVariantSerializer *pSerializer, unsigned keyframeInterval = DefaultKeyframeInterval);
+
+    /**
+     * @brief Encode a snapshot.
+     * @param value Snapshot.
+     */
+    void pushValue(const Variant &value);
+
+    /**
+     * @brief Decode next snapshot.
+     * A delta whose base snapshot is not known (e.g. it has been lost) is
+     * skipped and false is returned, decoding resumes with next keyframe.
+     * @param value Decoded snapshot.
+     * @return false if there is no frame or the frame cannot be decoded.
+     */
+    bool popValue(Variant &value);
+
+    /**
+     * @brief Sender: receiver has decoded a snapshot.
+     * Following deltas are computed against it.
+     * @param sequence Sequence number of the snapshot.
+     */
+    void acknowledge(unsigned sequence);
+
+    /**
+     * @brief Sender: make the next frame a keyframe.
+     */
+    void requestKeyframe() { m_keyframeRequested = true; }
+
+    /**
+     * @brief Returns sequence number of the last pushed or popped snapshot.
+     */
+    unsigned sequence() const { return m_sequence; }
+
+    /**
+     * @brief Forget all snapshots and restart sequence numbering.
+     */
+    void reset();
+
+private:
+
+    /// Snapshots by sequence number.
+    typedef std::map<unsigned, Variant> SnapshotMap;
+
+    void prune(unsigned keep);
+
+    IVariantSerializer *m_pSerializer;  ///< Frame serializer.
+    unsigned m_keyframeInterval;        ///< Maximum number of frames between keyframes.
+    unsigned m_sequence;                ///< Last sequence number.
+    unsigned m_sinceKeyframe;           ///< Frames sent since the last keyframe.
+    unsigned m_acknowledged;            ///< Last acknowledged sequence number, 0 if none.
+    bool m_keyframeRequested;           ///< Next frame is a keyframe.
+    SnapshotMap m_snapshots;            ///< Unacknowledged (sender) or recent (receiver) snapshots.
+};
+
+} // namespace ucxx
+
+#endif // UCXX_DELTASERIALIZER_H
@@ -0,0 +1,196 @@
+#ifndef UCXX_ENDIAN_H
+#define UCXX_ENDIAN_H
+
+//
+// Byte order conversion and alignment-safe raw value access
+//
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef _MSC_VER
+#   include <stdlib.h>
+#endif
+
+/*
+ * Host byte order detection.
+ * Windows targets are always little-endian, other compilers
+ * provide __BYTE_ORDER__ predefined macro (GCC >= 4.6, Clang).
+ */
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__)
+#   if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#       define UCXX_BIG_ENDIAN 1
+#   endif
+#endif
+
+namespace ucxx {
+
+/**
+ * @brief Reverse byte order of a 16-bit value.
+ */
+inline uint16_t byteSwap(uint16_t value)
+{
+#if defined(_MSC_VER)
+    return _byteswap_ushort(value);
+#elif defined(__GNUC__)
+    return __builtin_bswap16(value);
+#else
+    return (uint16_t)((value << 8) | (value >> 8));
+#endif
+}
+
+/**
+ * @brief Reverse byte order of a 32-bit value.
+ */
+inline uint32_t byteSwap(uint32_t value)
+{
+#if defined(_MSC_VER)
+    return _byteswap_ulong(value);
+#elif defined(__GNUC__)
+    return __builtin_bswap32(value);
+#else
+    return ((value & 0x000000FFu) << 24) | ((value & 0x0000FF00u) << 8) |
+           ((value & 0x00FF0000u) >> 8)  | ((value & 0xFF000000u) >> 24);
+#endif
+}
+
+/**
+ * @brief Reverse byte order of a 64-bit value.
+ */
+inline uint64_t byteSwap(uint64_t value)
+{
+#if defined(_MSC_VER)
+    return _byteswap_uint64(value);
+#elif defined(__GNUC__)
+    return __builtin_bswap64(value);
+#else
+    return ((uint64_t)byteSwap((uint32_t)value) << 32) | byteSwap((uint32_t)(value >> 32));
+#endif
+}
+
+inline uint8_t byteSwap(uint8_t value)
+{
+    return value;
+}
+
+/**
+ * @brief Convert between host and little-endian byte order.
+ * This is a no-op on little-endian hosts.
+ */
+template <typename U>
+inline U hostToLittleEndian(U value)
+{
+#ifdef UCXX_BIG_ENDIAN
+    return byteSwap(value);
+#else
+    return value;
+#endif
+}
+
+/**
+ * @brief Convert between host and big-endian (network) byte order.
+ * This is a no-op on big-endian hosts.
+ */
+template <typename U>
+inline U hostToBigEndian(U value)
+{
+#ifdef UCXX_BIG_ENDIAN
+    return value;
+#else
+    return byteSwap(value);
+#endif
+}
+
+/**
+ * @brief Unsigned integer type of given size in bytes.
+ */
+template <size_t N> struct UnsignedOfSize;
+template <> struct UnsignedOfSize<1> { typedef uint8_t Type; };
+template <> struct UnsignedOfSize<2> { typedef uint16_t Type; };
+template <> struct UnsignedOfSize<4> { typedef uint32_t Type; };
+template <> struct UnsignedOfSize<8> { typedef uint64_t Type; };
+
+/**
+ * @brief Store a value into a buffer in little-endian byte order.
+ * The buffer does not have to be aligned.
+ * @param pBuffer Destination buffer, must have at least sizeof(T) bytes.
+ * @param value Value to be stored.
+ */
+template <typename T>
+inline void storeLittleEndian(char *pBuffer, T value)
+{
+    typedef typename UnsignedOfSize<sizeof(T)>::Type U;
+    U raw;
+    memcpy(&raw, &value, sizeof(T));
+    raw = hostToLittleEndian(raw);
+    memcpy(pBuffer, &raw, sizeof(T));
+}
+
+/**
+ * @brief Load a little-endian value from a buffer.
+ * The buffer does not have to be aligned.
+ * @param pBuffer Source buffer, must have at least sizeof(T) bytes.
+ * @return Value in host byte order.
+ */
+template <typename T>
+inline T loadLittleEndian(const char *pBuffer)
+{
+    typedef typename UnsignedOfSize<sizeof(T)>::Type U;
+    U raw;
+    memcpy(&raw, pBuffer, sizeof(T));
+    raw = hostToLittleEndian(raw);
+    T value;
+    memcpy(&value, &raw, sizeof(T));
+    return value;
+}
+
+/**
+ * @brief Store a value into a buffer in big-endian byte order.
+ * The buffer does not have to be aligned.
+ * @param pBuffer Destination buffer, must have at least sizeof(T) bytes.
+ * @param value Value to be stored.
+ */
+template <typename T>
+inline void storeBigEndian(char *pBuffer, T value)
+{
+    typedef typename UnsignedOfSize<sizeof(T)>::Type U;
+    U raw;
+    memcpy(&raw, &value, sizeof(T));
+    raw = hostToBigEndian(raw);
+    memcpy(pBuffer, &raw, sizeof(T));
+}
+
+/**
+ * @brief Load a big-endian value from a buffer.
+ * The buffer does not have to be aligned.
+ * @param pBuffer Source buffer, must have at least sizeof(T) bytes.
+ * @return Value in host byte order.
+ */
+template <typename T>
+inline T loadBigEndian(const char *pBuffer)
+{
+    typedef typename UnsignedOfSize<sizeof(T)>::Type U;
+    U raw;
+    memcpy(&raw, pBuffer, sizeof(T));
+    raw = hostToBigEndian(raw);
+    T value;
+    memcpy(&value, &raw, sizeof(T));
+    return value;
+}
+
+// Booleans are stored as a single 0/1 byte.
+template <>
+inline void storeLittleEndian<bool>(char *pBuffer, bool value)
+{
+    *pBuffer = value ? 1 : 0;
+}
+
+template <>
+inline bool loadLittleEndian<bool>(const char *pBuffer)
+{
+    return *pBuffer != 0;
+}
+
+} // namespace ucxx
+
+#endif // UCXX_ENDIAN_H
@@ -0,0 +1,58 @@
+#include "Clock.h"
+#include "Event.h"
+
+namespace ucxx {
+
+Event::Event(bool manualReset, bool signaled)
+    : m_manualReset(manualReset),
+      m_signaled(signaled)
+{
+}
+
+void Event::set()
+{
+    MutexLocker locker(&m_mutex);
+    if (m_signaled) {
+        return;
+    }
+    m_signaled = true;
+    if (m_manualReset) {
+        m_cond.notifyAll();
+    } else {
+        m_cond.notifyOne();
+    }
+}
+
+void Event::reset()
+{
+    MutexLocker locker(&m_mutex);
+    m_signaled = false;
+}
+
+bool Event::wait(unsigned milliseconds)
+{
+    uint64_t deadline = Clock::milliseconds() + milliseconds;
+    MutexLocker locker(&m_mutex);
+    while (!m_signaled) {
+        unsigned timeout = 0;
+        if (milliseconds > 0) {
+            timeout = Clock::remaining(deadline);
+            if (timeout == 0) {
+                return false;
+            }
+        }
+        m_cond.wait(&m_mutex, timeout);
+    }
+    if (!m_manualReset) {
+        m_signaled = false;
+    }
+    return true;
+}
+
+bool Event::isSet() const
+{
+    MutexLocker locker(&m_mutex);
+    return m_signaled;
+}
+
+} // namespace ucxx
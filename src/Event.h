@@ -0,0 +1,67 @@
+#ifndef UCXX_EVENT_H
+#define UCXX_EVENT_H
+
+//
+// Event synchronization primitive
+//
+
+#include "Mutex.h"
+#include "ConditionVariable.h"
+
+namespace ucxx {
+
+/**
+ * @brief Signaled/non-signaled flag threads can wait for.
+ * A manual-reset event stays signaled until reset() and releases all
+ * waiting threads. An auto-reset event releases a single waiting thread
+ * and is reset by it.
+ */
+class Event
+{
+public:
+
+    /**
+     * @brief Construct an event.
+     * @param manualReset true for a manual-reset event.
+     * @param signaled Initial state.
+     */
+    explicit Event(bool manualReset = false, bool signaled = false);
+
+    /**
+     * @brief Signal the event.
+     */
+    void set();
+
+    /**
+     * @brief Reset the event to non-signaled state.
+     */
+    void reset();
+
+    /**
+     * @brief Wait until the event is signaled.
+     * An auto-reset event is reset on return.
+     * @param milliseconds Waiting timeout, 0 to wait forever.
+     * @return false on timeout.
+     */
+    bool wait(unsigned milliseconds = 0);
+
+    /**
+     * @brief Tells whether the event is signaled.
+     */
+    bool isSet() const;
+
+private:
+
+    // Disable copying
+    Event(const Event&);
+    Event& operator =(const Event&);
+
+    mutable Mutex m_mutex;          ///< Protects the state.
+    ConditionVariable m_cond;       ///< Waiting threads sleep here.
+    bool m_manualReset;             ///< Reset mode.
+    bool m_signaled;                ///< Event state.
+};
+
+} // namespace ucxx
+
+#endif // UCXX_EVENT_H
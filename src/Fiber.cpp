@@ -0,0 +1,563 @@
+#ifndef WIN32
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#ifdef __linux__
+#   include <sys/epoll.h>
+#endif
+
+#include <deque>
+#include <map>
+#include "Clock.h"
+#include "Mutex.h"
+#include "Thread.h"
+#include "ThreadPool.h"
+#include "Fiber.h"
+
+namespace ucxx {
+
+/// Fiber state.
+struct FiberScheduler::Context
+{
+    ucontext_t context;                 ///< Saved registers and stack.
+    void *pStack;                       ///< Stack memory, guard page included.
+    std::function<void()> function;     ///< Fiber body.
+    Worker *pWorker;                    ///< Thread running the fiber.
+    bool finished;                      ///< Body has returned.
+    int fd;                             ///< Descriptor waited for, -1 if none.
+    short events;                       ///< Awaited poll() events.
+    bool timedOut;                      ///< Wait ended by the deadline.
+    bool hasDeadline;                   ///< Wait has a deadline.
+    std::multimap<uint64_t, Context*>::iterator deadline;   ///< Entry in the worker deadlines.
+
+    explicit Context(const std::function<void()> &body)
+        : pStack(0), function(body), pWorker(0), finished(false),
+          fd(-1), events(0), timedOut(false), hasDeadline(false) {}
+};
+
+/// Fibers waiting for a descriptor.
+struct FiberScheduler::Descriptor
+{
+    Context *pReader;                   ///< Fiber waiting to read, null if none.
+    Context *pWriter;                   ///< Fiber waiting to write, null if none.
+
+    Descriptor() : pReader(0), pWriter(0) {}
+};
+
+/// Scheduler thread.
+struct FiberScheduler::Worker : public IRunnable
+{
+    FiberScheduler *pScheduler;                 ///< Owning scheduler.
+    Thread *pThread;                            ///< Scheduler thread.
+    ucontext_t context;                         ///< Scheduler context, fibers switch back here.
+    std::deque<Context*> ready;                 ///< Fibers ready to run.
+    std::multimap<uint64_t, Context*> deadlines;    ///< Waiting fibers by deadline.
+    std::map<int, Descriptor> descriptors;      ///< Awaited descriptors.
+#ifdef __linux__
+    int epoll;                                  ///< Poller of awaited descriptors.
+#endif
+    int wakeFds[2];                             ///< Pipe waking the thread up.
+    FastMutex inboxMutex;                       ///< Protects the inbox.
+    std::vector<Context*> inbox;                ///< Fibers spawned from other threads.
+
+    explicit Worker(FiberScheduler *scheduler) : pScheduler(scheduler), pThread(0)
+    {
+#ifdef __linux__
+        epoll = -1;
+#endif
+        wakeFds[0] = -1;
+        wakeFds[1] = -1;
+    }
+
+    void run() { pScheduler->work(this); }
+};
+
+thread_local FiberScheduler::Context *FiberScheduler::s_pCurrent = 0;
+
+namespace {
+
+/// Maximum number of stacks kept for reuse.
+const size_t MaxCachedStacks = 1024;
+
+size_t pageSize()
+{
+    static size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+} // namespace
+
+FiberScheduler::FiberScheduler(unsigned threadCount, size_t stackSize)
+    : m_next(0),
+      m_fiberCount(0),
+      m_stopping(false)
+{
+    if (threadCount == 0) {
+        threadCount = ThreadPool::processorCount();
+    }
+    size_t page = pageSize();
+    m_stackSize = (stackSize + page - 1) / page * page;
+
+    for (unsigned i = 0; i < threadCount; i++) {
+        Worker *pWorker = new Worker(this);
+        bool ready = pipe(pWorker->wakeFds) == 0;
+        if (ready) {
+            fcntl(pWorker->wakeFds[0], F_SETFL, O_NONBLOCK);
+            fcntl(pWorker->wakeFds[1], F_SETFL, O_NONBLOCK);
+        }
+#ifdef __linux__
+        if (ready) {
+            pWorker->epoll = epoll_create1(0);
+            struct epoll_event event;
+            event.events = EPOLLIN;
+            event.data.fd = pWorker->wakeFds[0];
+            ready = pWorker->epoll >= 0 &&
+                    epoll_ctl(pWorker->epoll, EPOLL_CTL_ADD, pWorker->wakeFds[0], &event) == 0;
+        }
+#endif
+        if (ready) {
+            pWorker->pThread = new Thread(pWorker);
+            pWorker->pThread->setName("ucxx-fiber");
+            ready = pWorker->pThread->start();
+        }
+        if (!ready) {
+            destroy(pWorker);
+            continue;
+        }
+        m_workers.push_back(pWorker);
+    }
+}
+
+FiberScheduler::~FiberScheduler()
+{
+    m_stopping.store(true);
+    for (size_t i = 0; i < m_workers.size(); i++) {
+        wakeUp(m_workers[i]);
+    }
+
+    for (size_t i = 0; i < m_workers.size(); i++) {
+        m_workers[i]->pThread->join();
+    }
+    for (size_t i = 0; i < m_workers.size(); i++) {
+        destroy(m_workers[i]);
+    }
+    for (size_t i = 0; i < m_stacks.size(); i++) {
+        munmap(m_stacks[i], m_stackSize + pageSize());
+    }
+}
+
+bool FiberScheduler::spawn(IRunnable *pRunnable)
+{
+    return add([pRunnable]() { pRunnable->run(); });
+}
+
+size_t FiberScheduler::fiberCount() const
+{
+    return m_fiberCount.load();
+}
+
+bool FiberScheduler::add(const std::function<void()> &function)
+{
+    if (m_workers.empty()) {
+        return false;
+    }
+    void *pStack = allocateStack();
+    if (pStack == 0) {
+        return false;
+    }
+
+    Context *pContext = new Context(function);
+    pContext->pStack = pStack;
+    m_fiberCount.fetch_add(1);
+
+    Context *pCurrent = s_pCurrent;
+    if (pCurrent != 0 && pCurrent->pWorker->pScheduler == this) {
+        // Spawned by a fiber, stay on its thread
+        start(pCurrent->pWorker, pContext);
+        return true;
+    }
+
+    Worker *pWorker = m_workers[m_next.fetch_add(1, std::memory_order_relaxed) % m_workers.size()];
+    bool wasEmpty;
+    {
+        LockGuard<FastMutex> guard(&pWorker->inboxMutex);
+        wasEmpty = pWorker->inbox.empty();
+        pWorker->inbox.push_back(pContext);
+    }
+    // A non-empty inbox has already been signaled
+    if (wasEmpty) {
+        wakeUp(pWorker);
+    }
+    return true;
+}
+
+void FiberScheduler::work(Worker *pWorker)
+{
+    std::vector<Context*> spawned;
+    for (;;) {
+        {
+            LockGuard<FastMutex> guard(&pWorker->inboxMutex);
+            spawned.swap(pWorker->inbox);
+        }
+        for (size_t i = 0; i < spawned.size(); i++) {
+            start(pWorker, spawned[i]);
+        }
+        spawned.clear();
+
+        // Fibers yielding now run in the next round, after polling
+        size_t count = pWorker->ready.size();
+        for (size_t i = 0; i < count; i++) {
+            Context *pContext = pWorker->ready.front();
+            pWorker->ready.pop_front();
+            resume(pWorker, pContext);
+        }
+
+        if (m_stopping.load() && m_fiberCount.load() == 0) {
+            break;
+        }
+
+        int timeout = -1;
+        if (!pWorker->ready.empty()) {
+            timeout = 0;
+        } else if (!pWorker->deadlines.empty()) {
+            timeout = static_cast<int>(Clock::remaining(pWorker->deadlines.begin()->first));
+        }
+        poll(pWorker, timeout);
+        expire(pWorker);
+    }
+}
+
+void FiberScheduler::start(Worker *pWorker, Context *pContext)
+{
+    pContext->pWorker = pWorker;
+
+    getcontext(&pContext->context);
+    pContext->context.uc_stack.ss_sp = pContext->pStack;
+    pContext->context.uc_stack.ss_size = m_stackSize + pageSize();
+    pContext->context.uc_link = 0;
+    makecontext(&pContext->context, &FiberScheduler::entry, 0);
+
+    pWorker->ready.push_back(pContext);
+}
+
+void FiberScheduler::resume(Worker *pWorker, Context *pContext)
+{
+    s_pCurrent = pContext;
+    swapcontext(&pWorker->context, &pContext->context);
+    s_pCurrent = 0;
+
+    if (pContext->finished) {
+        releaseStack(pContext->pStack);
+        delete pContext;
+        if (m_fiberCount.fetch_sub(1) == 1 && m_stopping.load()) {
+            // Threads sleeping in the poller must notice
+            for (size_t i = 0; i < m_workers.size(); i++) {
+                wakeUp(m_workers[i]);
+            }
+        }
+    }
+}
+
+void FiberScheduler::poll(Worker *pWorker, int timeout)
+{
+    // Waking up a fiber modifies the descriptors, collect them first
+    std::vector<std::pair<Context*, Context*> > woken;
+    bool signaled = false;
+#ifdef __linux__
+    struct epoll_event events[64];
+    int count = epoll_wait(pWorker->epoll, events, 64, timeout);
+    for (int i = 0; i < count; i++) {
+        int fd = events[i].data.fd;
+        if (fd == pWorker->wakeFds[0]) {
+            signaled = true;
+            continue;
+        }
+        std::map<int, Descriptor>::iterator it = pWorker->descriptors.find(fd);
+        if (it == pWorker->descriptors.end()) {
+            continue;
+        }
+        bool failed = (events[i].events & (EPOLLERR | EPOLLHUP)) != 0;
+        woken.push_back(std::make_pair(
+                (failed || (events[i].events & EPOLLIN)) ? it->second.pReader : 0,
+                (failed || (events[i].events & EPOLLOUT)) ? it->second.pWriter : 0));
+    }
+#else
+    std::vector<struct pollfd> fds;
+    struct pollfd wakeFd = { pWorker->wakeFds[0], POLLIN, 0 };
+    fds.push_back(wakeFd);
+    for (std::map<int, Descriptor>::iterator it = pWorker->descriptors.begin(); it != pWorker->descriptors.end(); ++it) {
+        struct pollfd fd = { it->first, 0, 0 };
+        fd.events = (it->second.pReader != 0 ? POLLIN : 0) | (it->second.pWriter != 0 ? POLLOUT : 0);
+        fds.push_back(fd);
+    }
+    if (::poll(&fds[0], fds.size(), timeout) > 0) {
+        signaled = fds[0].revents != 0;
+        for (size_t i = 1; i < fds.size(); i++) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            const Descriptor &descriptor = pWorker->descriptors[fds[i].fd];
+            bool failed = (fds[i].revents & (POLLERR | POLLHUP | POLLNVAL)) != 0;
+            woken.push_back(std::make_pair(
+                    (failed || (fds[i].revents & POLLIN)) ? descriptor.pReader : 0,
+                    (failed || (fds[i].revents & POLLOUT)) ? descriptor.pWriter : 0));
+        }
+    }
+#endif
+
+    for (size_t i = 0; i < woken.size(); i++) {
+        if (woken[i].first != 0) {
+            wake(pWorker, woken[i].first, false);
+        }
+        if (woken[i].second != 0) {
+            wake(pWorker, woken[i].second, false);
+        }
+    }
+    if (signaled) {
+        char buffer[64];
+        while (read(pWorker->wakeFds[0], buffer, sizeof(buffer)) > 0) {
+        }
+    }
+}
+
+void FiberScheduler::wake(Worker *pWorker, Context *pContext, bool timedOut)
+{
+    if (pContext->fd >= 0) {
+        std::map<int, Descriptor>::iterator it = pWorker->descriptors.find(pContext->fd);
+        if (it != pWorker->descriptors.end()) {
+            if (it->second.pReader == pContext) {
+                it->second.pReader = 0;
+            }
+            if (it->second.pWriter == pContext) {
+                it->second.pWriter = 0;
+            }
+            watch(pWorker, pContext->fd, false);
+        }
+        pContext->fd = -1;
+    }
+    if (pContext->hasDeadline) {
+        pWorker->deadlines.erase(pContext->deadline);
+        pContext->hasDeadline = false;
+    }
+    pContext->timedOut = timedOut;
+    pWorker->ready.push_back(pContext);
+}
+
+void FiberScheduler::expire(Worker *pWorker)
+{
+    uint64_t now = Clock::milliseconds();
+    while (!pWorker->deadlines.empty() && pWorker->deadlines.begin()->first <= now) {
+        wake(pWorker, pWorker->deadlines.begin()->second, true);
+    }
+}
+
+void* FiberScheduler::allocateStack()
+{
+    {
+        LockGuard<FastMutex> guard(&m_stackMutex);
+        if (!m_stacks.empty()) {
+            void *pStack = m_stacks.back();
+            m_stacks.pop_back();
+            return pStack;
+        }
+    }
+
+    // The lowest page stays inaccessible, stacks grow downwards
+    size_t size = m_stackSize + pageSize();
+    void *pStack = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pStack == MAP_FAILED) {
+        return 0;
+    }
+    if (mprotect(pStack, pageSize(), PROT_NONE) != 0) {
+        munmap(pStack, size);
+        return 0;
+    }
+    return pStack;
+}
+
+void FiberScheduler::releaseStack(void *pStack)
+{
+    {
+        LockGuard<FastMutex> guard(&m_stackMutex);
+        if (m_stacks.size() < MaxCachedStacks) {
+            m_stacks.push_back(pStack);
+            return;
+        }
+    }
+    munmap(pStack, m_stackSize + pageSize());
+}
+
+void FiberScheduler::entry()
+{
+    Context *pContext = s_pCurrent;
+    pContext->function();
+    // Release captured objects while still running in the fiber
+    pContext->function = std::function<void()>();
+    pContext->finished = true;
+    suspend();
+}
+
+void FiberScheduler::suspend()
+{
+    Context *pContext = s_pCurrent;
+    swapcontext(&pContext->context, &pContext->pWorker->context);
+}
+
+bool FiberScheduler::wait(int fd, short events, unsigned milliseconds)
+{
+    Context *pContext = s_pCurrent;
+    Worker *pWorker = pContext->pWorker;
+
+    if (fd >= 0) {
+        std::map<int, Descriptor>::iterator it = pWorker->descriptors.find(fd);
+        bool added = it == pWorker->descriptors.end();
+        if (added) {
+            it = pWorker->descriptors.insert(std::make_pair(fd, Descriptor())).first;
+        }
+        Context *&pWaiter = (events & POLLIN) ? it->second.pReader : it->second.pWriter;
+        if (pWaiter != 0) {
+            // Another fiber waits for the same direction
+            errno = EBUSY;
+            return false;
+        }
+        pWaiter = pContext;
+        if (!watch(pWorker, fd, added)) {
+            // errno set by epoll_ctl() is preserved
+            int error = errno;
+            pWaiter = 0;
+            if (added) {
+                pWorker->descriptors.erase(it);
+            }
+            errno = error;
+            return false;
+        }
+        pContext->fd = fd;
+        pContext->events = events;
+    }
+    if (milliseconds > 0) {
+        pContext->deadline = pWorker->deadlines.insert(std::make_pair(Clock::milliseconds() + milliseconds, pContext));
+        pContext->hasDeadline = true;
+    }
+
+    suspend();
+    if (pContext->timedOut) {
+        // Other fibers ran meanwhile, errno is only meaningful if set here
+        errno = ETIMEDOUT;
+        return false;
+    }
+    return true;
+}
+
+bool FiberScheduler::watch(Worker *pWorker, int fd, bool added)
+{
+    std::map<int, Descriptor>::iterator it = pWorker->descriptors.find(fd);
+    const Descriptor &descriptor = it->second;
+    bool idle = descriptor.pReader == 0 && descriptor.pWriter == 0;
+#ifdef __linux__
+    // One registration per descriptor, with the events of both waiters
+    bool res;
+    if (idle) {
+        res = epoll_ctl(pWorker->epoll, EPOLL_CTL_DEL, fd, 0) == 0;
+    } else {
+        struct epoll_event event;
+        event.events = (descriptor.pReader != 0 ? EPOLLIN : 0) | (descriptor.pWriter != 0 ? EPOLLOUT : 0);
+        event.data.fd = fd;
+        res = epoll_ctl(pWorker->epoll, added ? EPOLL_CTL_ADD : EPOLL_CTL_MOD, fd, &event) == 0;
+    }
+#else
+    bool res = true;
+#endif
+    if (idle) {
+        pWorker->descriptors.erase(it);
+    }
+    return res;
+}
+
+void FiberScheduler::wakeUp(Worker *pWorker)
+{
+    char c = 0;
+    if (write(pWorker->wakeFds[1], &c, 1) < 0) {
+        // Pipe full, the thread is woken up anyway
+    }
+}
+
+void FiberScheduler::destroy(Worker *pWorker)
+{
+#ifdef __linux__
+    if (pWorker->epoll >= 0) {
+        close(pWorker->epoll);
+    }
+#endif
+    if (pWorker->wakeFds[0] >= 0) {
+        close(pWorker->wakeFds[0]);
+        close(pWorker->wakeFds[1]);
+    }
+    delete pWorker->pThread;
+    delete pWorker;
+}
+
+//----------------------------------------------------------
+// class Fiber implementation
+//----------------------------------------------------------
+
+bool Fiber::isFiber()
+{
+    return FiberScheduler::s_pCurrent != 0;
+}
+
+void Fiber::yield()
+{
+    FiberScheduler::Context *pContext = FiberScheduler::s_pCurrent;
+    if (pContext == 0) {
+        sched_yield();
+        return;
+    }
+    pContext->pWorker->ready.push_back(pContext);
+    FiberScheduler::suspend();
+}
+
+void Fiber::sleep(unsigned milliseconds)
+{
+    if (!isFiber()) {
+        Thread::sleep(milliseconds);
+    } else if (milliseconds == 0) {
+        yield();
+    } else {
+        FiberScheduler::wait(-1, 0, milliseconds);
+    }
+}
+
+bool Fiber::waitReadable(int fd, unsigned milliseconds)
+{
+    if (!isFiber()) {
+        struct pollfd pfd = { fd, POLLIN, 0 };
+        int res = ::poll(&pfd, 1, milliseconds > 0 ? static_cast<int>(milliseconds) : -1);
+        if (res == 0) {
+            errno = ETIMEDOUT;
+        }
+        return res > 0;
+    }
+    return FiberScheduler::wait(fd, POLLIN, milliseconds);
+}
+
+bool Fiber::waitWritable(int fd, unsigned milliseconds)
+{
+    if (!isFiber()) {
+        struct pollfd pfd = { fd, POLLOUT, 0 };
+        int res = ::poll(&pfd, 1, milliseconds > 0 ? static_cast<int>(milliseconds) : -1);
+        if (res == 0) {
+            errno = ETIMEDOUT;
+        }
+        return res > 0;
+    }
+    return FiberScheduler::wait(fd, POLLOUT, milliseconds);
+}
+
+} // namespace ucxx
+
+#endif // WIN32
@@ -0,0 +1,181 @@
+#ifndef UCXX_FIBER_H
+#define UCXX_FIBER_H
+
+//
+// Stackful fibers scheduled over a few threads
+//
+
+#include <stddef.h>
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <type_traits>
+#include "IExecutor.h"
+#include "Mutex.h"
+
+namespace ucxx {
+
+/**
+ * @brief Scheduler running fibers on a few threads.
+ * A fiber is a function running on its own stack, which can be suspended
+ * at any call depth and resumed later, so code written as blocking calls
+ * runs without occupying a thread while it waits. Fibers are cooperative:
+ * a fiber runs until it finishes or waits (see Fiber), then its thread
+ * switches to another fiber ready to run. Waiting for a descriptor
+ * registers it in the poller of the thread (epoll on Linux, poll()
+ * elsewhere) and the fiber is resumed once the descriptor is ready or
+ * the timeout expires.
+ *
+ * TcpSocket and TcpServer called from a fiber wait this way instead of
+ * blocking, so connection handlers keep the blocking style while tens of
+ * thousands of connections are served by a few threads. Other blocking
+ * calls (e.g. Thread::sleep(), a long held Mutex) block all fibers of the
+ * thread.
+ *
+ * A fiber stays on the thread it was started on. Fibers spawned from a
+ * fiber of the same scheduler run on the thread of their parent, other
+ * ones are distributed round-robin. Stacks are allocated with a guard
+ * page, so an overflow crashes instead of corrupting memory, and are
+ * reused by later fibers. A descriptor may be waited for by one reading
+ * and one writing fiber at a time, e.g. a socket with a receiving and
+ * a sending fiber.
+ * Not available on Windows.
+ */
+class FiberScheduler
+{
+    friend class Fiber;
+public:
+
+    /**
+     * @brief Construct a scheduler and start its threads.
+     * Threads which cannot be created are left out, see threadCount().
+     * @param threadCount Number of threads, 0 for the number of processors.
+     * @param stackSize Stack size of each fiber in bytes.
+     */
+    explicit FiberScheduler(unsigned threadCount = 1, size_t stackSize = 64 * 1024);
+
+    /**
+     * @brief Destructor.
+     * Waits until all fibers (including fibers they spawn in turn) have
+     * finished and then stops the threads. Must not be called from a fiber
+     * of this scheduler.
+     */
+    ~FiberScheduler();
+
+    /**
+     * @brief Start a fiber running a task.
+     * @param pRunnable Task to be run, not owned by the scheduler.
+     * @return false if the fiber stack cannot be allocated or the
+     * scheduler has no thread.
+     */
+    bool spawn(IRunnable *pRunnable);
+
+    /**
+     * @brief Start a fiber running a callable.
+     * @param function Callable object invoked without arguments.
+     * @return false if the fiber stack cannot be allocated or the
+     * scheduler has no thread.
+     */
+    template <typename F>
+    typename std::enable_if<!std::is_convertible<F, IRunnable*>::value, bool>::type spawn(F function)
+    {
+        return add(std::function<void()>(function));
+    }
+
+    /**
+     * @brief Returns number of running scheduler threads.
+     */
+    unsigned threadCount() const { return static_cast<unsigned>(m_workers.size()); }
+
+    /**
+     * @brief Returns number of fibers not finished yet.
+     */
+    size_t fiberCount() const;
+
+private:
+
+    // Disable copying
+    FiberScheduler(const FiberScheduler&);
+    FiberScheduler& operator =(const FiberScheduler&);
+
+    struct Context;
+    struct Descriptor;
+    struct Worker;
+
+    bool add(const std::function<void()> &function);
+    void work(Worker *pWorker);
+    void start(Worker *pWorker, Context *pContext);
+    void resume(Worker *pWorker, Context *pContext);
+    void poll(Worker *pWorker, int timeout);
+    void wake(Worker *pWorker, Context *pContext, bool timedOut);
+    void expire(Worker *pWorker);
+    void* allocateStack();
+    void releaseStack(void *pStack);
+
+    static void entry();
+    static void suspend();
+    static bool wait(int fd, short events, unsigned milliseconds);
+    static bool watch(Worker *pWorker, int fd, bool added);
+    static void wakeUp(Worker *pWorker);
+    static void destroy(Worker *pWorker);
+
+    size_t m_stackSize;                 ///< Usable stack size, guard page excluded.
+    std::vector<Worker*> m_workers;     ///< Scheduler threads.
+    FastMutex m_stackMutex;             ///< Protects the stack cache.
+    std::vector<void*> m_stacks;        ///< Stacks of finished fibers, for reuse.
+    std::atomic<unsigned> m_next;       ///< Round-robin thread of the next spawned fiber.
+    std::atomic<size_t> m_fiberCount;   ///< Fibers not finished yet.
+    std::atomic<bool> m_stopping;       ///< Threads exit once out of fibers.
+
+    static thread_local Context *s_pCurrent;    ///< Fiber running in the calling thread.
+};
+
+/**
+ * @brief Operations of the calling fiber.
+ * Called outside of a fiber, the operations block the calling thread.
+ */
+class Fiber
+{
+public:
+
+    /**
+     * @brief Tells whether the calling code runs in a fiber.
+     */
+    static bool isFiber();
+
+    /**
+     * @brief Let other ready fibers of the thread run.
+     */
+    static void yield();
+
+    /**
+     * @brief Suspend the calling fiber for given time.
+     */
+    static void sleep(unsigned milliseconds);
+
+    /**
+     * @brief Wait until a descriptor can be read without blocking.
+     * Only one fiber may wait to read a descriptor at a time.
+     * @param fd Descriptor, e.g. a socket.
+     * @param milliseconds Waiting timeout, 0 to wait forever.
+     * @return false on timeout (errno is ETIMEDOUT) or error.
+     */
+    static bool waitReadable(int fd, unsigned milliseconds = 0);
+
+    /**
+     * @brief Wait until a descriptor can be written without blocking.
+     * Only one fiber may wait to write a descriptor at a time.
+     * @param fd Descriptor, e.g. a socket.
+     * @param milliseconds Waiting timeout, 0 to wait forever.
+     * @return false on timeout (errno is ETIMEDOUT) or error.
+     */
+    static bool waitWritable(int fd, unsigned milliseconds = 0);
+
+private:
+
+    Fiber();
+};
+
+} // namespace ucxx
+
+#endif // UCXX_FIBER_H
@@ -0,0 +1,493 @@
+#ifndef UCXX_FUTURE_H
+#define UCXX_FUTURE_H
+
+//
+// Futures, promises and continuations
+//
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <type_traits>
+#include "IExecutor.h"
+#include "Mutex.h"
+#include "Sema.h"
+
+namespace ucxx {
+
+template <typename T> class Future;
+template <typename T> class Promise;
+template <typename R> struct PromiseCompleter;
+
+/// Type storing the value of a state, futures of void store a flag.
+template <typename T>
+struct FutureStorage
+{
+    typedef T Type;
+};
+
+template <>
+struct FutureStorage<void>
+{
+    typedef bool Type;
+};
+
+/**
+ * @brief State shared by a promise and its futures.
+ * A state is completed exactly once, either with a value or with an error.
+ * Callbacks receive the state, so they do not need to hold it, which
+ * would make the state own itself until completed.
+ */
+template <typename T>
+class FutureState : public std::enable_shared_from_this<FutureState<T> >
+{
+public:
+
+    typedef typename FutureStorage<T>::Type Value;
+    typedef std::function<void(const std::shared_ptr<FutureState>&)> Callback;
+
+    FutureState() : m_mutex("Future"), m_ready(false), m_failed(false), m_waiters(0) {}
+
+    /**
+     * @brief Complete the state.
+     * @param pValue Value, or null to complete with an error.
+     * @param error Error message.
+     * @return false if the state has already been completed.
+     */
+    bool complete(const Value *pValue, const std::string &error)
+    {
+        std::vector<Callback> callbacks;
+        int waiters;
+        {
+            MutexLocker locker(&m_mutex);
+            if (m_ready) {
+                return false;
+            }
+            if (pValue != 0) {
+                m_value = *pValue;
+            } else {
+                m_failed = true;
+                m_error = error;
+            }
+            m_ready = true;
+            callbacks.swap(m_callbacks);
+            waiters = m_waiters;
+        }
+
+        if (waiters > 0) {
+            m_semaphore.notify(waiters);
+        }
+        if (!callbacks.empty()) {
+            std::shared_ptr<FutureState> pSelf = this->shared_from_this();
+            for (size_t i = 0; i < callbacks.size(); i++) {
+                callbacks[i](pSelf);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Register a completion callback.
+     * The callback is run by the completing thread, or immediately
+     * if the state is already complete.
+     */
+    void onComplete(const Callback &callback)
+    {
+        {
+            MutexLocker locker(&m_mutex);
+            if (!m_ready) {
+                m_callbacks.push_back(callback);
+                return;
+            }
+        }
+        callback(this->shared_from_this());
+    }
+
+    bool wait(unsigned milliseconds)
+    {
+        {
+            MutexLocker locker(&m_mutex);
+            if (m_ready) {
+                return true;
+            }
+            ++m_waiters;
+        }
+
+        bool res = m_semaphore.wait(milliseconds);
+        if (!res) {
+            // A notification may still arrive, it is consumed by nobody
+            MutexLocker locker(&m_mutex);
+            --m_waiters;
+            return m_ready;
+        }
+        return true;
+    }
+
+    bool isReady()
+    {
+        MutexLocker locker(&m_mutex);
+        return m_ready;
+    }
+
+    // Valid once ready
+    bool isFailed() const { return m_failed; }
+    const Value& value() const { return m_value; }
+    const std::string& error() const { return m_error; }
+
+private:
+
+    Mutex m_mutex;          ///< Protects the state.
+    Semaphore m_semaphore;  ///< Waiting threads block here.
+    bool m_ready;           ///< Completion flag.
+    bool m_failed;          ///< Completed with an error.
+    int m_waiters;          ///< Number of threads blocked in wait().
+    Value m_value;          ///< Result value.
+    std::string m_error;    ///< Error message.
+    std::vector<Callback> m_callbacks;  ///< Completion callbacks.
+};
+
+/**
+ * @brief Members common to Future<T> and Future<void>.
+ */
+template <typename T>
+class FutureBase
+{
+public:
+
+    /**
+     * @brief Tells whether the future is bound to a promise.
+     */
+    bool isValid() const { return m_pState != 0; }
+
+    bool isReady() const { return m_pState->isReady(); }
+
+    /**
+     * @brief Tells whether the future has completed with an error.
+     * The result is only meaningful once the future is ready.
+     */
+    bool isError() const { return isReady() && m_pState->isFailed(); }
+
+    /**
+     * @brief Returns the error message, empty unless completed with an error.
+     */
+    std::string error() const { return isError() ? m_pState->error() : std::string(); }
+
+    /**
+     * @brief Wait for the result.
+     * @note Waiting inside a ThreadPool task occupies the worker; prefer
+     * then() there, or help the pool with ThreadPool::runPendingTask().
+     * @param milliseconds Waiting timeout, 0 to wait forever.
+     * @return false on timeout.
+     */
+    bool wait(unsigned milliseconds = 0) const { return m_pState->wait(milliseconds); }
+
+    /**
+     * @brief Attach a callback run on completion, whether successful or not.
+     * @param function Callable taking the future (const Future<T>&).
+     * @param pExecutor Executor running the callback, null to run it inline.
+     */
+    template <typename F>
+    void onComplete(F function, IExecutor *pExecutor = 0) const
+    {
+        m_pState->onComplete([function, pExecutor](const std::shared_ptr<FutureState<T> > &pState) {
+            F callback = function;
+            Future<T> future(pState);
+            executeCallable(pExecutor, [callback, future]() mutable {
+                callback(future);
+            });
+        });
+    }
+
+protected:
+
+    FutureBase() {}
+    FutureBase(const std::shared_ptr<FutureState<T> > &pState) : m_pState(pState) {}
+
+    /**
+     * @brief Attach a continuation completing a promise.
+     * @param pExecutor Executor running the continuation, null to run it inline.
+     * @param run Callable taking the (successfully completed) state and the
+     * promise to be completed.
+     */
+    template <typename R, typename F>
+    Future<R> chain(IExecutor *pExecutor, F run) const
+    {
+        Promise<R> promise;
+        m_pState->onComplete([promise, run, pExecutor](const std::shared_ptr<FutureState<T> > &pState) {
+            Promise<R> next = promise;
+            F continuation = run;
+            executeCallable(pExecutor, [pState, next, continuation]() mutable {
+                if (pState->isFailed()) {
+                    next.setError(pState->error());
+                } else {
+                    continuation(pState, next);
+                }
+            });
+        });
+        return promise.future();
+    }
+
+    std::shared_ptr<FutureState<T> > m_pState;  ///< Shared result.
+};
+
+/**
+ * @brief Result of an asynchronous operation.
+ * Futures are cheap to copy, all copies refer to the same result.
+ * A future is completed through its Promise with either a value or an
+ * error message. Continuations attached with then() run once the result
+ * is available and produce futures in turn, so processing stages can be
+ * chained without blocking a thread per stage. An error skips the
+ * continuations and is passed along the chain. Future<void> signals
+ * completion only, its continuations take no argument.
+ */
+template <typename T>
+class Future : public FutureBase<T>
+{
+public:
+
+    /**
+     * @brief Construct an invalid future.
+     */
+    Future() {}
+
+    /**
+     * @brief Wait for and return the value.
+     * A default-constructed value is returned if the future has failed.
+     */
+    const T& get() const
+    {
+        this->wait();
+        return this->m_pState->value();
+    }
+
+    /**
+     * @brief Attach a continuation.
+     * @param function Callable taking the value (const T&), its result
+     * (possibly void) completes the returned future.
+     * @param pExecutor Executor running the continuation, if null the
+     * continuation runs in the thread completing this future (or at once
+     * if this future is already complete).
+     * @return Future of the continuation result.
+     */
+    template <typename F>
+    Future<typename std::result_of<F(const T&)>::type> then(F function, IExecutor *pExecutor = 0) const
+    {
+        typedef typename std::result_of<F(const T&)>::type R;
+        return this->template chain<R>(pExecutor,
+            [function](const std::shared_ptr<FutureState<T> > &pState, Promise<R> &promise) mutable {
+                auto call = [&function, &pState]() { return function(pState->value()); };
+                PromiseCompleter<R>::complete(promise, call);
+            });
+    }
+
+private:
+    friend class Promise<T>;
+    friend class FutureBase<T>;
+
+    Future(const std::shared_ptr<FutureState<T> > &pState) : FutureBase<T>(pState) {}
+};
+
+/**
+ * @brief Future signaling completion without a value.
+ */
+template <>
+class Future<void> : public FutureBase<void>
+{
+public:
+
+    /**
+     * @brief Construct an invalid future.
+     */
+    Future() {}
+
+    /**
+     * @brief Wait for completion.
+     */
+    void get() const { wait(); }
+
+    /**
+     * @brief Attach a continuation.
+     * @param function Callable without arguments, its result (possibly
+     * void) completes the returned future.
+     * @param pExecutor Executor running the continuation, if null the
+     * continuation runs in the thread completing this future (or at once
+     * if this future is already complete).
+     * @return Future of the continuation result.
+     */
+    template <typename F>
+    Future<typename std::result_of<F()>::type> then(F function, IExecutor *pExecutor = 0) const
+    {
+        typedef typename std::result_of<F()>::type R;
+        return chain<R>(pExecutor,
+            [function](const std::shared_ptr<FutureState<void> >&, Promise<R> &promise) mutable {
+                PromiseCompleter<R>::complete(promise, function);
+            });
+    }
+
+private:
+    friend class Promise<void>;
+    friend class FutureBase<void>;
+
+    Future(const std::shared_ptr<FutureState<void> > &pState) : FutureBase<void>(pState) {}
+};
+
+/**
+ * @brief Producer side of a Future.
+ * Promises are cheap to copy, all copies complete the same future, the
+ * first completion wins. A promise that is never completed leaves its
+ * futures waiting forever.
+ */
+template <typename T>
+class Promise
+{
+public:
+
+    Promise() : m_pState(new FutureState<T>()) {}
+
+    Future<T> future() const { return Future<T>(m_pState); }
+
+    /**
+     * @brief Complete with a value.
+     * @return false if already completed.
+     */
+    bool setValue(const T &value) { return m_pState->complete(&value, std::string()); }
+
+    /**
+     * @brief Complete with an error.
+     * @return false if already completed.
+     */
+    bool setError(const std::string &error) { return m_pState->complete(0, error); }
+
+private:
+    std::shared_ptr<FutureState<T> > m_pState;  ///< Shared result.
+};
+
+/**
+ * @brief Producer side of a Future<void>.
+ */
+template <>
+class Promise<void>
+{
+public:
+
+    Promise() : m_pState(new FutureState<void>()) {}
+
+    Future<void> future() const { return Future<void>(m_pState); }
+
+    /**
+     * @brief Complete successfully.
+     * @return false if already completed.
+     */
+    bool setValue()
+    {
+        bool done = true;
+        return m_pState->complete(&done, std::string());
+    }
+
+    /**
+     * @brief Complete with an error.
+     * @return false if already completed.
+     */
+    bool setError(const std::string &error) { return m_pState->complete(0, error); }
+
+private:
+    std::shared_ptr<FutureState<void> > m_pState;   ///< Shared result.
+};
+
+/**
+ * @brief Complete a promise with the result of a callable.
+ * Specialized for void results, which complete the promise once the
+ * callable has returned.
+ */
+template <typename R>
+struct PromiseCompleter
+{
+    template <typename F>
+    static void complete(Promise<R> &promise, F &function) { promise.setValue(function()); }
+};
+
+template <>
+struct PromiseCompleter<void>
+{
+    template <typename F>
+    static void complete(Promise<void> &promise, F &function)
+    {
+        function();
+        promise.setValue();
+    }
+};
+
+/**
+ * @brief Run a callable asynchronously.
+ * @param pExecutor Executor running the callable.
+ * @param function Callable invoked without arguments, possibly returning void.
+ * @return Future of the callable result.
+ */
+template <typename F>
+Future<typename std::result_of<F()>::type> runAsync(IExecutor *pExecutor, F function)
+{
+    typedef typename std::result_of<F()>::type R;
+    Promise<R> promise;
+    executeCallable(pExecutor, [promise, function]() mutable {
+        PromiseCompleter<R>::complete(promise, function);
+    });
+    return promise.future();
+}
+
+/**
+ * @brief Returns a future completed once all given futures are.
+ * Values are collected in the order of the futures. The result fails
+ * with the error of the first future failing.
+ */
+template <typename T>
+Future<std::vector<T> > whenAll(const std::vector<Future<T> > &futures)
+{
+    Promise<std::vector<T> > promise;
+    if (futures.empty()) {
+        promise.setValue(std::vector<T>());
+        return promise.future();
+    }
+
+    // Each callback fills its own slot, the last one completes the result
+    std::shared_ptr<std::vector<T> > pValues(new std::vector<T>(futures.size()));
+    std::shared_ptr<std::atomic<size_t> > pRemaining(new std::atomic<size_t>(futures.size()));
+    for (size_t i = 0; i < futures.size(); i++) {
+        futures[i].onComplete([promise, pValues, pRemaining, i](const Future<T> &future) mutable {
+            if (future.isError()) {
+                promise.setError(future.error());
+            } else {
+                (*pValues)[i] = future.get();
+            }
+            if (pRemaining->fetch_sub(1) == 1) {
+                promise.setValue(*pValues);
+            }
+        });
+    }
+    return promise.future();
+}
+
+/**
+ * @brief Returns a future completed once any of the given futures is.
+ * The value is the index of the first future completed (successfully
+ * or not). The result fails if there are no futures.
+ */
+template <typename T>
+Future<size_t> whenAny(const std::vector<Future<T> > &futures)
+{
+    Promise<size_t> promise;
+    if (futures.empty()) {
+        promise.setError("No futures to wait for");
+    }
+    for (size_t i = 0; i < futures.size(); i++) {
+        futures[i].onComplete([promise, i](const Future<T>&) mutable {
+            promise.setValue(i);
+        });
+    }
+    return promise.future();
+}
+
+} // namespace ucxx
+
+#endif // UCXX_FUTURE_H
@@ -0,0 +1,62 @@
+#ifndef UCXX_IEXECUTOR_H
+#define UCXX_IEXECUTOR_H
+
+//
+// Interface to an object executing tasks
+//
+
+#include "Thread.h"
+
+namespace ucxx {
+
+/**
+ * @brief Task execution interface.
+ * Implemented by ThreadPool, may be implemented e.g. by an event loop
+ * running tasks in its own thread.
+ */
+class IExecutor
+{
+public:
+
+    /**
+     * @brief Schedule a task for execution.
+     * @param pRunnable Task to be run, not owned by the executor.
+     */
+    virtual void execute(IRunnable *pRunnable) = 0;
+    virtual ~IExecutor() {}
+};
+
+/**
+ * @brief Runnable wrapper of a callable object.
+ * The wrapper deletes itself once run, so it can be handed over to an
+ * executor without keeping track of it.
+ */
+template <typename F>
+class CallableTask : public IRunnable
+{
+public:
+    CallableTask(const F &function) : m_function(function) {}
+    void run() { m_function(); delete this; }
+
+private:
+    F m_function;
+};
+
+/**
+ * @brief Schedule a callable object for execution.
+ * @param pExecutor Executor, the callable is run immediately if null.
+ * @param function Callable object invoked without arguments.
+ */
+template <typename F>
+void executeCallable(IExecutor *pExecutor, F function)
+{
+    if (pExecutor == 0) {
+        function();
+        return;
+    }
+    pExecutor->execute(new CallableTask<F>(function));
+}
+
+} // namespace ucxx
+
+#endif // UCXX_IEXECUTOR_H
@@ -0,0 +1,52 @@
+#include "Clock.h"
+#include "Latch.h"
+
+namespace ucxx {
+
+Latch::Latch(unsigned count)
+    : m_count(count)
+{
+}
+
+void Latch::countDown(unsigned n)
+{
+    MutexLocker locker(&m_mutex);
+    if (m_count == 0) {
+        return;
+    }
+    m_count = n < m_count ? m_count - n : 0;
+    if (m_count == 0) {
+        m_cond.notifyAll();
+    }
+}
+
+bool Latch::wait(unsigned milliseconds)
+{
+    uint64_t deadline = Clock::milliseconds() + milliseconds;
+    MutexLocker locker(&m_mutex);
+    while (m_count > 0) {
+        unsigned timeout = 0;
+        if (milliseconds > 0) {
+            timeout = Clock::remaining(deadline);
+            if (timeout == 0) {
+                return false;
+            }
+        }
+        m_cond.wait(&m_mutex, timeout);
+    }
+    return true;
+}
+
+bool Latch::tryWait() const
+{
+    MutexLocker locker(&m_mutex);
+    return m_count == 0;
+}
+
+unsigned Latch::count() const
+{
+    MutexLocker locker(&m_mutex);
+    return m_count;
+}
+
+} // namespace ucxx
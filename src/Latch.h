@@ -0,0 +1,66 @@
+#ifndef UCXX_LATCH_H
+#define UCXX_LATCH_H
+
+//
+// Single-use countdown latch
+//
+
+#include "Mutex.h"
+#include "ConditionVariable.h"
+
+namespace ucxx {
+
+/**
+ * @brief Countdown latch.
+ * Threads wait until the counter, set on construction, is counted down to
+ * zero, e.g. by workers finishing their parts of a job. Once open, the
+ * latch stays open.
+ */
+class Latch
+{
+public:
+
+    /**
+     * @brief Construct a latch.
+     * @param count Number of count downs opening the latch.
+     */
+    explicit Latch(unsigned count);
+
+    /**
+     * @brief Decrement the counter, releasing waiting threads when it
+     * reaches zero.
+     * @param n Decrement, the counter does not go below zero.
+     */
+    void countDown(unsigned n = 1);
+
+    /**
+     * @brief Wait until the latch is open.
+     * @param milliseconds Waiting timeout, 0 to wait forever.
+     * @return false on timeout.
+     */
+    bool wait(unsigned milliseconds = 0);
+
+    /**
+     * @brief Tells whether the latch is open, without waiting.
+     */
+    bool tryWait() const;
+
+    /**
+     * @brief Returns the current counter.
+     */
+    unsigned count() const;
+
+private:
+
+    // Disable copying
+    Latch(const Latch&);
+    Latch& operator =(const Latch&);
+
+    mutable Mutex m_mutex;          ///< Protects the counter.
+    ConditionVariable m_cond;       ///< Waiting threads sleep here.
+    unsigned m_count;               ///< Remaining count downs.
+};
+
+} // namespace ucxx
+
+#endif // UCXX_LATCH_H
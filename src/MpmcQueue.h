@@ -0,0 +1,303 @@
+#ifndef UCXX_MPMCQUEUE_H
+#define UCXX_MPMCQUEUE_H
+
+//
+// Lock-free bounded multi-producer multi-consumer queue
+//
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include "Sema.h"
+#include "Clock.h"
+
+namespace ucxx {
+
+/**
+ * @brief Bounded lock-free queue for any number of producers and consumers.
+ * Items are stored in a ring of cells, each cell carrying a sequence
+ * number which tells whether the cell is ready to be written or read in
+ * the current round (D. Vyukov's bounded MPMC queue). Producers and
+ * consumers claim cells by advancing their position with a single CAS,
+ * no lock is taken.
+ * Blocking variants spin shortly and then sleep on a semaphore; the
+ * semaphore is only notified while somebody sleeps, so the fast path of
+ * a busy queue involves no system call.
+ * T must be default-constructible and copy-assignable.
+ */
+template <typename T>
+class MpmcQueue
+{
+public:
+
+    /**
+     * @brief Construct an empty queue.
+     * @param capacity Maximum number of items, rounded up to a power of two.
+     */
+    explicit MpmcQueue(size_t capacity = 1024)
+        : m_enqueuePos(0), m_dequeuePos(0), m_waitingProducers(0), m_waitingConsumers(0)
+    {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        m_mask = size - 1;
+        m_pCells = new Cell[size];
+        for (size_t i = 0; i < size; i++) {
+            m_pCells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MpmcQueue()
+    {
+        delete[] m_pCells;
+    }
+
+    /**
+     * @brief Enqueue an item if there is room.
+     * @return false if the queue is full.
+     */
+    bool tryEnqueue(const T &item)
+    {
+        if (!push(item)) {
+            return false;
+        }
+        wake(m_waitingConsumers, m_itemSemaphore);
+        return true;
+    }
+
+    /**
+     * @brief Dequeue an item if there is any.
+     * @return false if the queue is empty.
+     */
+    bool tryDequeue(T &item)
+    {
+        if (!pop(item)) {
+            return false;
+        }
+        wake(m_waitingProducers, m_slotSemaphore);
+        return true;
+    }
+
+    /**
+     * @brief Enqueue an item.
+     * @note This method will block while the queue is full.
+     */
+    void enqueue(const T &item)
+    {
+        enqueue(item, 0);
+    }
+
+    /**
+     * @brief Enqueue an item, waiting for room at most given time.
+     * @param item Item to be enqueued.
+     * @param milliseconds Waiting timeout, 0 to wait forever.
+     * @return false on timeout.
+     */
+    bool enqueue(const T &item, unsigned milliseconds)
+    {
+        PushOperation op(this, item);
+        if (!block(op, m_waitingProducers, m_slotSemaphore, milliseconds)) {
+            return false;
+        }
+        wake(m_waitingConsumers, m_itemSemaphore);
+        return true;
+    }
+
+    /**
+     * @brief Dequeue an item.
+     * @note This method will block while the queue is empty.
+     */
+    T dequeue()
+    {
+        T item;
+        dequeue(item, 0);
+        return item;
+    }
+
+    /**
+     * @brief Dequeue an item, waiting for one at most given time.
+     * @param item Item dequeued.
+     * @param milliseconds Waiting timeout, 0 to wait forever.
+     * @return false on timeout.
+     */
+    bool dequeue(T &item, unsigned milliseconds)
+    {
+        PopOperation op(this, item);
+        if (!block(op, m_waitingConsumers, m_itemSemaphore, milliseconds)) {
+            return false;
+        }
+        wake(m_waitingProducers, m_slotSemaphore);
+        return true;
+    }
+
+    size_t capacity() const { return m_mask + 1; }
+
+    /**
+     * @brief Returns approximate number of items in the queue.
+     */
+    size_t count() const
+    {
+        size_t enqueued = m_enqueuePos.load(std::memory_order_relaxed);
+        size_t dequeued = m_dequeuePos.load(std::memory_order_relaxed);
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+private:
+
+    // Disable copying
+    MpmcQueue(const MpmcQueue&);
+    MpmcQueue& operator =(const MpmcQueue&);
+
+    /// Number of attempts before going to sleep.
+    static const int SpinCount = 100;
+
+    struct Cell {
+        std::atomic<size_t> sequence;   ///< Round in which the cell may be written or read.
+        T data;                         ///< Item.
+    };
+
+    struct PushOperation {
+        MpmcQueue *pQueue;
+        const T &item;
+        PushOperation(MpmcQueue *queue, const T &t) : pQueue(queue), item(t) {}
+        bool operator ()() { return pQueue->push(item); }
+    };
+
+    struct PopOperation {
+        MpmcQueue *pQueue;
+        T &item;
+        PopOperation(MpmcQueue *queue, T &t) : pQueue(queue), item(t) {}
+        bool operator ()() { return pQueue->pop(item); }
+    };
+
+    bool push(const T &item)
+    {
+        Cell *pCell;
+        size_t pos = m_enqueuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            pCell = &m_pCells[pos & m_mask];
+            size_t sequence = pCell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // Cell not consumed in the previous round yet
+                return false;
+            } else {
+                pos = m_enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        pCell->data = item;
+        pCell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &item)
+    {
+        Cell *pCell;
+        size_t pos = m_dequeuePos.load(std::memory_order_relaxed);
+        for (;;) {
+            pCell = &m_pCells[pos & m_mask];
+            size_t sequence = pCell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (m_dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // Cell not written in this round yet
+                return false;
+            } else {
+                pos = m_dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        item = pCell->data;
+        pCell->sequence.store(pos + m_mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*
+     * Sleeping protocol: a thread going to sleep registers itself in the
+     * waiting counter and retries, the other side checks the counter after
+     * its operation. The fences make sure at least one of them notices the
+     * other, so no wake-up is lost. A waker takes one sleeper off the counter
+     * before notifying, so every sleeper gets exactly one notification and
+     * a burst of operations does not pile up spurious wake-ups.
+     */
+
+    template <typename Operation>
+    bool block(Operation &op, std::atomic<unsigned> &waiting, Semaphore &semaphore, unsigned milliseconds)
+    {
+        for (int i = 0; i < SpinCount; i++) {
+            if (op()) {
+                return true;
+            }
+        }
+
+        uint64_t deadline = Clock::milliseconds() + milliseconds;
+        for (;;) {
+            waiting.fetch_add(1);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (op()) {
+                leave(waiting, semaphore);
+                return true;
+            }
+            unsigned timeout = 0;
+            if (milliseconds > 0) {
+                timeout = Clock::remaining(deadline);
+                if (timeout == 0) {
+                    leave(waiting, semaphore);
+                    return false;
+                }
+            }
+            if (!semaphore.wait(timeout)) {
+                leave(waiting, semaphore);
+            }
+        }
+    }
+
+    // Unregister a sleeper which has not been woken up.
+    void leave(std::atomic<unsigned> &waiting, Semaphore &semaphore)
+    {
+        unsigned count = waiting.load();
+        while (count > 0) {
+            if (waiting.compare_exchange_weak(count, count - 1)) {
+                return;
+            }
+        }
+        // A waker has already taken us off, consume its notification
+        semaphore.wait();
+    }
+
+    void wake(std::atomic<unsigned> &waiting, Semaphore &semaphore)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        unsigned count = waiting.load(std::memory_order_relaxed);
+        while (count > 0) {
+            if (waiting.compare_exchange_weak(count, count - 1)) {
+                semaphore.notify();
+                return;
+            }
+        }
+    }
+
+    // Positions are updated by different threads, keep them on separate cache lines
+    char m_padding0[64];
+    std::atomic<size_t> m_enqueuePos;   ///< Next cell to write.
+    char m_padding1[64];
+    std::atomic<size_t> m_dequeuePos;   ///< Next cell to read.
+    char m_padding2[64];
+    Cell *m_pCells;                     ///< Ring of cells.
+    size_t m_mask;                      ///< Ring size minus one.
+    std::atomic<unsigned> m_waitingProducers;   ///< Producers sleeping on a full queue.
+    std::atomic<unsigned> m_waitingConsumers;   ///< Consumers sleeping on an empty queue.
+    Semaphore m_slotSemaphore;          ///< Notified when a cell is freed.
+    Semaphore m_itemSemaphore;          ///< Notified when an item is added.
+};
+
+} // namespace ucxx
+
+#endif // UCXX_MPMCQUEUE_H
@@ -0,0 +1,518 @@
+#include <limits.h>
+#include "Endian.h"
+#include "MsgPackSerializer.h"
+
+namespace ucxx {
+
+/*
+ * MessagePack format markers.
+ */
+const uint8_t cPositiveFixIntMax = 0x7f;
+const uint8_t cFixMap       = 0x80;
+const uint8_t cFixArray     = 0x90;
+const uint8_t cFixStr       = 0xa0;
+const uint8_t cNil          = 0xc0;
+const uint8_t cFalse        = 0xc2;
+const uint8_t cTrue         = 0xc3;
+const uint8_t cBin8         = 0xc4;
+const uint8_t cBin16        = 0xc5;
+const uint8_t cBin32        = 0xc6;
+const uint8_t cFloat32      = 0xca;
+const uint8_t cFloat64      = 0xcb;
+const uint8_t cUInt8        = 0xcc;
+const uint8_t cUInt16       = 0xcd;
+const uint8_t cUInt32       = 0xce;
+const uint8_t cUInt64       = 0xcf;
+const uint8_t cInt8         = 0xd0;
+const uint8_t cInt16        = 0xd1;
+const uint8_t cInt32        = 0xd2;
+const uint8_t cInt64        = 0xd3;
+const uint8_t cStr8         = 0xd9;
+const uint8_t cStr16        = 0xda;
+const uint8_t cStr32        = 0xdb;
+const uint8_t cArray16      = 0xdc;
+const uint8_t cArray32      = 0xdd;
+const uint8_t cMap16        = 0xde;
+const uint8_t cMap32        = 0xdf;
+const uint8_t cNegativeFixIntMin = 0xe0;
+
+// Integers outside of int range are represented by real numbers.
+static void assignInteger(int64_t value, Variant &v)
+{
+    if (value >= INT_MIN && value <= INT_MAX) {
+        v = static_cast<int>(value);
+    } else {
+        v = static_cast<double>(value);
+    }
+}
+
+MsgPackSerializer::MsgPackSerializer()
+    : m_byteArray(),
+      m_pView(0),
+      m_viewSize(0)
+{
+    reset();
+}
+
+MsgPackSerializer::MsgPackSerializer(const ByteArray &ba)
+    : m_byteArray(ba),
+      m_pView(0),
+      m_viewSize(0)
+{
+    reset();
+}
+
+void MsgPackSerializer::initWith(const ByteArray &ba)
+{
+    m_byteArray = ba;
+    m_pView = 0;
+    m_viewSize = 0;
+    reset();
+}
+
+void MsgPackSerializer::attach(const char *pData, size_t size)
+{
+    m_byteArray.clear();
+    m_pView = pData;
+    m_viewSize = size;
+    reset();
+}
+
+void MsgPackSerializer::detach()
+{
+    if (m_pView != 0) {
+        m_byteArray = ByteArray(m_pView, m_viewSize);
+        m_pView = 0;
+        m_viewSize = 0;
+    }
+}
+
+size_t MsgPackSerializer::available() const
+{
+    return readSize() - m_index;
+}
+
+void MsgPackSerializer::reset()
+{
+    m_index = 0;
+}
+
+void MsgPackSerializer::pushValue(const Variant &value)
+{
+    if (m_pView != 0) {
+        detach();
+    }
+
+    switch (value.type()) {
+    case Variant::Type_Boolean:
+        m_byteArray.append(static_cast<char>(value.toBoolean() ? cTrue : cFalse));
+        break;
+    case Variant::Type_Integer:
+        pushInteger(value.toInteger());
+        break;
+    case Variant::Type_Real:
+        pushBigEndian<double>(cFloat64, value.toReal());
+        break;
+    case Variant::Type_String:
+        pushString(value.string());
+        break;
+    case Variant::Type_List:
+        pushList(value.list());
+        break;
+    case Variant::Type_Map:
+        pushMap(value.map());
+        break;
+    default:
+        // Null and invalid values
+        m_byteArray.append(static_cast<char>(cNil));
+        break;
+    }
+}
+
+bool MsgPackSerializer::popValue(Variant &value)
+{
+    // Incomplete or invalid value must not be partially consumed
+    // and leaves the value untouched
+    size_t index = m_index;
+    Variant v;
+    if (!decodeValue(v)) {
+        m_index = index;
+        return false;
+    }
+    value.swap(v);
+    return true;
+}
+
+void MsgPackSerializer::pushBinary(const char *pData, size_t size)
+{
+    if (m_pView != 0) {
+        detach();
+    }
+
+    if (size <= 0xff) {
+        pushBigEndian<uint8_t>(cBin8, size);
+    } else if (size <= 0xffff) {
+        pushBigEndian<uint16_t>(cBin16, size);
+    } else {
+        pushBigEndian<uint32_t>(cBin32, size);
+    }
+    m_byteArray.append(pData, size);
+}
+
+void MsgPackSerializer::pushInteger64(int64_t value)
+{
+    if (m_pView != 0) {
+        detach();
+    }
+
+    if (value >= INT_MIN && value <= INT_MAX) {
+        pushInteger(static_cast<int>(value));
+    } else if (value > 0) {
+        if (value <= 0xffffffffll) {
+            pushBigEndian<uint32_t>(cUInt32, value);
+        } else {
+            pushBigEndian<uint64_t>(cUInt64, value);
+        }
+    } else {
+        pushBigEndian<int64_t>(cInt64, value);
+    }
+}
+
+void MsgPackSerializer::pushFloat(float value)
+{
+    if (m_pView != 0) {
+        detach();
+    }
+    pushBigEndian<float>(cFloat32, value);
+}
+
+template <typename T>
+void MsgPackSerializer::pushBigEndian(uint8_t marker, T value)
+{
+    char buffer[1 + sizeof(T)];
+    buffer[0] = static_cast<char>(marker);
+    storeBigEndian<T>(buffer + 1, value);
+    m_byteArray.append(buffer, sizeof(buffer));
+}
+
+template <typename T>
+bool MsgPackSerializer::popBigEndian(T &value)
+{
+    if (available() < sizeof(T)) {
+        return false;
+    }
+    value = loadBigEndian<T>(readData() + m_index);
+    m_index += sizeof(T);
+    return true;
+}
+
+void MsgPackSerializer::pushInteger(int value)
+{
+    if (value >= 0) {
+        if (value <= cPositiveFixIntMax) {
+            m_byteArray.append(static_cast<char>(value));
+        } else if (value <= 0xff) {
+            pushBigEndian<uint8_t>(cUInt8, value);
+        } else if (value <= 0xffff) {
+            pushBigEndian<uint16_t>(cUInt16, value);
+        } else {
+            pushBigEndian<uint32_t>(cUInt32, value);
+        }
+    } else {
+        if (value >= -32) {
+            m_byteArray.append(static_cast<char>(value));
+        } else if (value >= SCHAR_MIN) {
+            pushBigEndian<int8_t>(cInt8, value);
+        } else if (value >= SHRT_MIN) {
+            pushBigEndian<int16_t>(cInt16, value);
+        } else {
+            pushBigEndian<int32_t>(cInt32, value);
+        }
+    }
+}
+
+void MsgPackSerializer::pushString(const std::string &value)
+{
+    size_t length = value.length();
+    if (length < 32) {
+        m_byteArray.append(static_cast<char>(cFixStr | length));
+    } else if (length <= 0xff) {
+        pushBigEndian<uint8_t>(cStr8, length);
+    } else if (length <= 0xffff) {
+        pushBigEndian<uint16_t>(cStr16, length);
+    } else {
+        pushBigEndian<uint32_t>(cStr32, length);
+    }
+    m_byteArray.append(value.c_str(), length);
+}
+
+void MsgPackSerializer::pushList(const VariantList &value)
+{
+    size_t size = value.size();
+    if (size < 16) {
+        m_byteArray.append(static_cast<char>(cFixArray | size));
+    } else if (size <= 0xffff) {
+        pushBigEndian<uint16_t>(cArray16, size);
+    } else {
+        pushBigEndian<uint32_t>(cArray32, size);
+    }
+    for (VariantList::const_iterator it = value.begin(); it != value.end(); ++it) {
+        pushValue(*it);
+    }
+}
+
+void MsgPackSerializer::pushMap(const VariantMap &value)
+{
+    size_t size = value.size();
+    if (size < 16) {
+        m_byteArray.append(static_cast<char>(cFixMap | size));
+    } else if (size <= 0xffff) {
+        pushBigEndian<uint16_t>(cMap16, size);
+    } else {
+        pushBigEndian<uint32_t>(cMap32, size);
+    }
+    for (VariantMap::const_iterator it = value.begin(); it != value.end(); ++it) {
+        pushString(it->first);
+        pushValue(it->second);
+    }
+}
+
+bool MsgPackSerializer::decodeValue(Variant &value)
+{
+    if (available() < 1) {
+        return false;
+    }
+
+    uint8_t marker = static_cast<uint8_t>(readData()[m_index++]);
+
+    if (marker <= cPositiveFixIntMax) {
+        value = static_cast<int>(marker);
+        return true;
+    }
+    if (marker >= cNegativeFixIntMin) {
+        value = static_cast<int>(static_cast<int8_t>(marker));
+        return true;
+    }
+    if ((marker & 0xf0) == cFixMap) {
+        return decodeMap(marker & 0x0f, value);
+    }
+    if ((marker & 0xf0) == cFixArray) {
+        return decodeArray(marker & 0x0f, value);
+    }
+    if ((marker & 0xe0) == cFixStr) {
+        value = Variant(Variant::Type_String);
+        return decodeString(marker & 0x1f, value.string());
+    }
+
+    switch (marker) {
+    case cNil:
+        value = Variant(Variant::Type_Null);
+        return true;
+    case cFalse:
+        value = false;
+        return true;
+    case cTrue:
+        value = true;
+        return true;
+    case cBin8:
+    case cStr8: {
+        uint8_t length;
+        value = Variant(Variant::Type_String);
+        return popBigEndian(length) && decodeString(length, value.string());
+    }
+    case cBin16:
+    case cStr16: {
+        uint16_t length;
+        value = Variant(Variant::Type_String);
+        return popBigEndian(length) && decodeString(length, value.string());
+    }
+    case cBin32:
+    case cStr32: {
+        uint32_t length;
+        value = Variant(Variant::Type_String);
+        return popBigEndian(length) && decodeString(length, value.string());
+    }
+    case cFloat32: {
+        float v;
+        if (!popBigEndian(v)) {
+            return false;
+        }
+        value = static_cast<double>(v);
+        return true;
+    }
+    case cFloat64: {
+        double v;
+        if (!popBigEndian(v)) {
+            return false;
+        }
+        value = v;
+        return true;
+    }
+    case cUInt8: {
+        uint8_t v;
+        if (!popBigEndian(v)) {
+            return false;
+        }
+        value = static_cast<int>(v);
+        return true;
+    }
+    case cUInt16: {
+        uint16_t v;
+        if (!popBigEndian(v)) {
+            return false;
+        }
+        value = static_cast<int>(v);
+        return true;
+    }
+    case cUInt32: {
+        uint32_t v;
+        if (!popBigEndian(v)) {
+            return false;
+        }
+        assignInteger(v, value);
+        return true;
+    }
+    case cUInt64: {
+        uint64_t v;
+        if (!popBigEndian(v)) {
+            return false;
+        }
+        if (v > static_cast<uint64_t>(INT64_MAX)) {
+            value = static_cast<double>(v);
+        } else {
+            assignInteger(static_cast<int64_t>(v), value);
+        }
+        return true;
+    }
+    case cInt8: {
+        int8_t v;
+        if (!popBigEndian(v)) {
+            return false;
+        }
+        value = static_cast<int>(v);
+        return true;
+    }
+    case cInt16: {
+        int16_t v;
+        if (!popBigEndian(v)) {
+            return false;
+        }
+        value = static_cast<int>(v);
+        return true;
+    }
+    case cInt32: {
+        int32_t v;
+        if (!popBigEndian(v)) {
+            return false;
+        }
+        value = static_cast<int>(v);
+        return true;
+    }
+    case cInt64: {
+        int64_t v;
+        if (!popBigEndian(v)) {
+            return false;
+        }
+        assignInteger(v, value);
+        return true;
+    }
+    case cArray16: {
+        uint16_t length;
+        return popBigEndian(length) && decodeArray(length, value);
+    }
+    case cArray32: {
+        uint32_t length;
+        return popBigEndian(length) && decodeArray(length, value);
+    }
+    case cMap16: {
+        uint16_t length;
+        return popBigEndian(length) && decodeMap(length, value);
+    }
+    case cMap32: {
+        uint32_t length;
+        return popBigEndian(length) && decodeMap(length, value);
+    }
+    default:
+        // Extension types and the reserved marker are not supported
+        break;
+    }
+
+    return false;
+}
+
+bool MsgPackSerializer::decodeString(size_t length, std::string &value)
+{
+    if (available() < length) {
+        return false;
+    }
+    value.assign(readData() + m_index, length);
+    m_index += length;
+    return true;
+}
+
+bool MsgPackSerializer::decodeArray(size_t length, Variant &value)
+{
+    // Each element takes at least one byte
+    if (available() < length) {
+        return false;
+    }
+
+    value = Variant(Variant::Type_List);
+    VariantList &list = value.list();
+    for (size_t i = 0; i < length; i++) {
+        list.push_back(Variant());
+        if (!decodeValue(list.back())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MsgPackSerializer::decodeMap(size_t length, Variant &value)
+{
+    // Each entry takes at least two bytes
+    if (available() / 2 < length) {
+        return false;
+    }
+
+    value = Variant(Variant::Type_Map);
+    VariantMap &map = value.map();
+    std::string key;
+    for (size_t i = 0; i < length; i++) {
+        if (!decodeKey(key)) {
+            return false;
+        }
+        if (!decodeValue(map[key])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MsgPackSerializer::decodeKey(std::string &key)
+{
+    if (available() < 1) {
+        return false;
+    }
+
+    // String keys are decoded directly, reusing the key buffer
+    uint8_t marker = static_cast<uint8_t>(readData()[m_index]);
+    if ((marker & 0xe0) == cFixStr) {
+        ++m_index;
+        return decodeString(marker & 0x1f, key);
+    }
+    if (marker == cStr8 || marker == cBin8) {
+        ++m_index;
+        uint8_t length;
+        return popBigEndian(length) && decodeString(length, key);
+    }
+
+    Variant v;
+    if (!decodeValue(v)) {
+        return false;
+    }
+    key = v.type() == Variant::Type_String ? v.string() : v.toString();
+    return true;
+}
+
+} // namespace ucxx
@@ -0,0 +1,109 @@
+#ifndef UCXX_MSGPACKSERIALIZER_H
+#define UCXX_MSGPACKSERIALIZER_H
+
+//
+// Variant serializer into MessagePack format
+//
+
+#include <stdint.h>
+#include "IVariantSerializer.h"
+#include "ByteArray.h"
+
+namespace ucxx {
+
+/**
+ * @brief Implementation of IVariantSerializer interface producing MessagePack.
+ * Variant types are mapped as follows:
+ *
+ *     Invalid, Null  -> nil
+ *     Boolean        -> true / false
+ *     Integer        -> the smallest fixint, int or uint encoding
+ *     Real           -> float 64
+ *     String         -> str
+ *     List           -> array
+ *     Map            -> map with str keys
+ *
+ * Decoding accepts any MessagePack value except extension types:
+ * nil decodes as Null, str and bin as String, float 32 and 64 as Real,
+ * integers as Integer when they fit into int and as Real otherwise.
+ * Non-string map keys are converted into their textual representation.
+ */
+class MsgPackSerializer : public IVariantSerializer
+{
+public:
+    MsgPackSerializer();
+    MsgPackSerializer(const ByteArray &ba);
+
+    void initWith(const ByteArray &ba);
+
+    /**
+     * @brief Decode from an external buffer without copying it.
+     * The buffer must stay valid and unmodified while values are being
+     * popped. Pushing a value copies the buffer into the internal byte
+     * array first, after which the external buffer is no longer referenced.
+     * @param pData Encoded data.
+     * @param size Number of bytes.
+     */
+    void attach(const char *pData, size_t size);
+
+    size_t available() const;
+
+    // IVariantSerializer interface
+    void pushValue(const Variant &value);
+
+    /**
+     * @brief Decode next value.
+     * Nothing is consumed and the value is left unchanged if the encoded
+     * value is incomplete or invalid.
+     * @param v Decoded value.
+     * @return false if there is no complete value or the data is invalid.
+     */
+    bool popValue(Variant &v);
+
+    // Reset read index to zero.
+    void reset();
+
+    /**
+     * @brief Returns the internal byte array.
+     * @note The array is empty while an external buffer is attached.
+     */
+    const ByteArray& byteArray() const { return m_byteArray; }
+
+    /*
+     * MessagePack types having no Variant counterpart.
+     * They decode as String, Integer or Real respectively.
+     */
+
+    void pushBinary(const char *pData, size_t size);
+    void pushInteger64(int64_t value);
+    void pushFloat(float value);
+
+private:
+
+    void detach();
+    const char* readData() const { return m_pView != 0 ? m_pView : m_byteArray.constData(); }
+    size_t readSize() const { return m_pView != 0 ? m_viewSize : m_byteArray.size(); }
+
+    bool decodeValue(Variant &value);
+    bool decodeString(size_t length, std::string &value);
+    bool decodeArray(size_t length, Variant &value);
+    bool decodeMap(size_t length, Variant &value);
+    bool decodeKey(std::string &key);
+
+    template <typename T> void pushBigEndian(uint8_t marker, T value);
+    template <typename T> bool popBigEndian(T &value);
+
+    void pushInteger(int value);
+    void pushString(const std::string &value);
+    void pushList(const VariantList &value);
+    void pushMap(const VariantMap &value);
+
+    ByteArray m_byteArray;  ///< Internal byte array serialization buffer.
+    const char *m_pView;    ///< Attached external buffer, decoded instead of the byte array.
+    size_t m_viewSize;      ///< Size of the attached buffer.
+    size_t m_index;         ///< Read index.
+};
+
+} // namespace ucxx
+
+#endif // UCXX_MSGPACKSERIALIZER_H
@@ -8,11 +8,23 @@
 
 #include <assert.h>
 #include "Mutex.h"
+#ifdef UCXX_MUTEX_PROFILING
+#   include "Clock.h"
+#endif
 
 namespace ucxx {
 
-Mutex::Mutex()
+Mutex::Mutex(const char *pName)
 {
+#ifdef UCXX_MUTEX_PROFILING
+    m_pProfile = MutexProfiler::profile(pName);
+    m_lockTime = 0;
+    m_depth = 0;
+#else
+    (void)pName;
+#endif
+
+
 #ifdef WIN32
     m_mutex = 0;
     m_mutex = CreateMutex(0, FALSE, 0);
@@ -42,7 +54,7 @@ Mutex::~Mutex()
 #endif
 }
 
-void Mutex::lock()
+void Mutex::lockNative()
 {
 #ifdef WIN32
     DWORD dwWaitResult;
@@ -53,7 +65,7 @@ void Mutex::lock()
 #endif
 }
 
-void Mutex::unlock()
+void Mutex::unlockNative()
 {
 #ifdef WIN32
     ReleaseMutex(m_mutex);
@@ -62,7 +74,7 @@ void Mutex::unlock()
 #endif
 }
 
-bool Mutex::tryLock()
+inline bool Mutex::tryLockNative()
 {
 #ifdef WIN32
     DWORD dwWaitResult = WaitForSingleObject(m_mutex, 0);
@@ -79,6 +91,137 @@ bool Mutex::tryLock()
     return false;
 }
 
+void Mutex::lock()
+{
+#ifdef UCXX_MUTEX_PROFILING
+    if (tryLockNative()) {
+        acquired(0, false);
+        return;
+    }
+    uint64_t start = Clock::microseconds();
+    lockNative();
+    acquired(Clock::microseconds() - start, true);
+#else
+    lockNative();
+#endif
+}
+
+void Mutex::unlock()
+{
+#ifdef UCXX_MUTEX_PROFILING
+    released();
+#endif
+    unlockNative();
+}
+
+bool Mutex::tryLock()
+{
+#ifdef UCXX_MUTEX_PROFILING
+    if (!tryLockNative()) {
+        return false;
+    }
+    acquired(0, false);
+    return true;
+#else
+    return tryLockNative();
+#endif
+}
+
+#ifdef UCXX_MUTEX_PROFILING
+
+void Mutex::acquired(uint64_t wait, bool contended)
+{
+    // Recursive locks by the owner are neither acquisitions nor holds
+    if (m_depth++ == 0) {
+        m_lockTime = Clock::microseconds();
+        MutexProfiler::recordAcquisition(m_pProfile, wait, contended);
+    }
+}
+
+void Mutex::released()
+{
+    if (--m_depth == 0) {
+        MutexProfiler::recordHold(m_pProfile, Clock::microseconds() - m_lockTime);
+    }
+}
+
+uint64_t Mutex::suspended()
+{
+    // Released by a condition wait: the hold goes on once the wait returns
+    if (--m_depth == 0) {
+        return Clock::microseconds() - m_lockTime;
+    }
+    return 0;
+}
+
+void Mutex::resumed(uint64_t held)
+{
+    // Taken back by the wait, which is not an acquisition: the time spent
+    // relocking cannot be told apart from waiting for the notification
+    if (m_depth++ == 0) {
+        m_lockTime = Clock::microseconds() - held;
+    }
+}
+
+#endif // UCXX_MUTEX_PROFILING
+
+//----------------------------------------------------------
+// class FastMutex implementation
+//----------------------------------------------------------
+
+FastMutex::FastMutex()
+{
+#ifdef WIN32
+    InitializeCriticalSectionAndSpinCount(&m_mutex, 1000);
+#else
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+#if defined(PTHREAD_ADAPTIVE_MUTEX_INITIALIZER_NP)
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_ADAPTIVE_NP);
+#else
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_NORMAL);
+#endif
+    pthread_mutex_init(&m_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+#endif
+}
+
+FastMutex::~FastMutex()
+{
+#ifdef WIN32
+    DeleteCriticalSection(&m_mutex);
+#else
+    pthread_mutex_destroy(&m_mutex);
+#endif
+}
+
+void FastMutex::lock()
+{
+#ifdef WIN32
+    EnterCriticalSection(&m_mutex);
+#else
+    pthread_mutex_lock(&m_mutex);
+#endif
+}
+
+void FastMutex::unlock()
+{
+#ifdef WIN32
+    LeaveCriticalSection(&m_mutex);
+#else
+    pthread_mutex_unlock(&m_mutex);
+#endif
+}
+
+bool FastMutex::tryLock()
+{
+#ifdef WIN32
+    return TryEnterCriticalSection(&m_mutex) != 0;
+#else
+    return pthread_mutex_trylock(&m_mutex) == 0;
+#endif
+}
+
 //----------------------------------------------------------
 // class MutexLocker implementation
 //----------------------------------------------------------
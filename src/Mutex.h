@@ -11,22 +11,32 @@
 #   include <pthread.h>
 #endif
 
+#ifdef UCXX_MUTEX_PROFILING
+#   include <stdint.h>
+#   include "MutexProfiler.h"
+#endif
+
 namespace ucxx {
 
 /**
  * @brief Platform-specific mutex implementation.
  * The mutex implemented by this class is recursive, meaning it can
  * be locked multiple times from the same thread.
+ * With UCXX_MUTEX_PROFILING defined, contention and hold times are
+ * recorded under the mutex name, see MutexProfiler.
  */
 class Mutex
 {
+    friend class ConditionVariable;
 public:
 
     /**
      * @brief Construct a mutex.
      * Constructed mutex is unlocked by default.
+     * @param pName Name the mutex is profiled under, not copied (use
+     * a string literal); null for the shared "unnamed" entry.
      */
-    Mutex();
+    explicit Mutex(const char *pName = 0);
 
     /**
      * @brief Destroy the mutex.
@@ -58,12 +68,76 @@ private:
     Mutex(const Mutex&) {}
     Mutex& operator =(const Mutex&) { return *this; }
 
+    void lockNative();
+    void unlockNative();
+    bool tryLockNative();
+
     /// Platform-specific mutex implementation.
 #ifdef WIN32
     HANDLE m_mutex;
 #else
     pthread_mutex_t m_mutex;
 #endif
+
+#ifdef UCXX_MUTEX_PROFILING
+    void acquired(uint64_t wait, bool contended);
+    void released();
+    uint64_t suspended();
+    void resumed(uint64_t held);
+
+    MutexProfiler::Profile *m_pProfile; ///< Statistics of the mutex name.
+    uint64_t m_lockTime;                ///< Time of the outermost lock.
+    unsigned m_depth;                   ///< Recursion depth of the owner.
+#endif
+};
+
+/**
+ * @brief Non-recursive mutex.
+ * Cheaper than Mutex as it does no recursion bookkeeping; on Linux it is
+ * an adaptive mutex, spinning shortly before sleeping when the owner
+ * is running on another processor. Locking the mutex again from the
+ * owning thread is undefined (it deadlocks on most platforms).
+ */
+class FastMutex
+{
+public:
+
+    /**
+     * @brief Construct an unlocked mutex.
+     */
+    FastMutex();
+
+    ~FastMutex();
+
+    /**
+     * @brief Acquire a lock on this mutex.
+     * This method will block if the mutex is already locked by another thread.
+     */
+    void lock();
+
+    /**
+     * @brief Release the mutex.
+     */
+    void unlock();
+
+    /**
+     * @brief Attempt to lock the mutex.
+     * @return true if mutex lock has been acquired, false if locked by another thread.
+     */
+    bool tryLock();
+
+private:
+
+    // Disable copying
+    FastMutex(const FastMutex&);
+    FastMutex& operator =(const FastMutex&);
+
+    /// Platform-specific mutex implementation.
+#ifdef WIN32
+    CRITICAL_SECTION m_mutex;
+#else
+    pthread_mutex_t m_mutex;
+#endif
 };
 
 /**
@@ -98,6 +172,49 @@ private:
     Mutex *m_pMutex;
 };
 
+/**
+ * @brief Lock helper class for any lock type.
+ * Works like MutexLocker with any class providing lock() and unlock()
+ * methods, such as FastMutex or SpinLock.
+ */
+template <typename L>
+class LockGuard
+{
+public:
+
+    /**
+     * @brief Construct the locker.
+     * @note This will immediately attempt to lock the lock.
+     * @param pLock Pointer to the lock to be locked.
+     */
+    explicit LockGuard(L *pLock)
+        : m_pLock(pLock)
+    {
+        if (m_pLock) {
+            m_pLock->lock();
+        }
+    }
+
+    /**
+     * @brief Unlock the lock.
+     */
+    ~LockGuard()
+    {
+        if (m_pLock) {
+            m_pLock->unlock();
+        }
+    }
+
+private:
+
+    // Disable copying
+    LockGuard(const LockGuard&);
+    LockGuard& operator =(const LockGuard&);
+
+    /// Lock object to be handled by this locker.
+    L *m_pLock;
+};
+
 } // namespace ucxx
 
 #endif // UCXX_MUTEX_H
@@ -0,0 +1,180 @@
+#include <stdio.h>
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include "Mutex.h"
+#include "MutexProfiler.h"
+
+namespace ucxx {
+
+struct MutexProfiler::Profile
+{
+    std::string name;
+    std::atomic<uint64_t> acquisitions;
+    std::atomic<uint64_t> contentions;
+    std::atomic<uint64_t> totalWait;
+    std::atomic<uint64_t> maxWait;
+    std::atomic<uint64_t> totalHold;
+    std::atomic<uint64_t> maxHold;
+    std::atomic<uint64_t> waitHistogram[MutexStatistics::HistogramSize];
+    std::atomic<uint64_t> holdHistogram[MutexStatistics::HistogramSize];
+
+    explicit Profile(const std::string &profileName) : name(profileName) { clear(); }
+
+    void clear()
+    {
+        acquisitions.store(0);
+        contentions.store(0);
+        totalWait.store(0);
+        maxWait.store(0);
+        totalHold.store(0);
+        maxHold.store(0);
+        for (unsigned i = 0; i < MutexStatistics::HistogramSize; i++) {
+            waitHistogram[i].store(0);
+            holdHistogram[i].store(0);
+        }
+    }
+};
+
+/// Profiles by name.
+struct MutexProfiler::Registry
+{
+    FastMutex mutex;
+    std::map<std::string, Profile*> profiles;
+};
+
+namespace {
+
+unsigned bucket(uint64_t duration)
+{
+    unsigned i = 0;
+    while (duration > 0 && i < MutexStatistics::HistogramSize - 1) {
+        duration >>= 1;
+        i++;
+    }
+    return i;
+}
+
+void updateMax(std::atomic<uint64_t> &max, uint64_t value)
+{
+    uint64_t current = max.load(std::memory_order_relaxed);
+    while (value > current && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+bool byTotalWait(const MutexStatistics &a, const MutexStatistics &b)
+{
+    return a.totalWait > b.totalWait;
+}
+
+} // namespace
+
+MutexProfiler::Registry& MutexProfiler::registry()
+{
+    // Never destroyed, static mutexes may outlive it
+    static Registry *pRegistry = new Registry();
+    return *pRegistry;
+}
+
+bool MutexProfiler::isEnabled()
+{
+#ifdef UCXX_MUTEX_PROFILING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void MutexProfiler::snapshot(std::vector<MutexStatistics> &statistics)
+{
+    statistics.clear();
+
+    Registry &r = registry();
+    LockGuard<FastMutex> guard(&r.mutex);
+    for (std::map<std::string, Profile*>::const_iterator it = r.profiles.begin(); it != r.profiles.end(); ++it) {
+        const Profile *pProfile = it->second;
+        MutexStatistics s;
+        s.name = pProfile->name;
+        s.acquisitions = pProfile->acquisitions.load(std::memory_order_relaxed);
+        s.contentions = pProfile->contentions.load(std::memory_order_relaxed);
+        s.totalWait = pProfile->totalWait.load(std::memory_order_relaxed);
+        s.maxWait = pProfile->maxWait.load(std::memory_order_relaxed);
+        s.totalHold = pProfile->totalHold.load(std::memory_order_relaxed);
+        s.maxHold = pProfile->maxHold.load(std::memory_order_relaxed);
+        for (unsigned i = 0; i < MutexStatistics::HistogramSize; i++) {
+            s.waitHistogram[i] = pProfile->waitHistogram[i].load(std::memory_order_relaxed);
+            s.holdHistogram[i] = pProfile->holdHistogram[i].load(std::memory_order_relaxed);
+        }
+        statistics.push_back(s);
+    }
+    std::stable_sort(statistics.begin(), statistics.end(), byTotalWait);
+}
+
+std::string MutexProfiler::dump()
+{
+    std::vector<MutexStatistics> statistics;
+    snapshot(statistics);
+
+    std::string result;
+    char line[256];
+    snprintf(line, sizeof(line), "%-24s %12s %12s %7s %10s %10s %10s %10s\n",
+             "name", "acquisitions", "contentions", "cont%", "avg wait", "max wait", "avg hold", "max hold");
+    result += line;
+    for (size_t i = 0; i < statistics.size(); i++) {
+        const MutexStatistics &s = statistics[i];
+        double percent = s.acquisitions > 0 ? 100.0 * s.contentions / s.acquisitions : 0.0;
+        unsigned long long avgWait = s.contentions > 0 ? s.totalWait / s.contentions : 0;
+        unsigned long long avgHold = s.acquisitions > 0 ? s.totalHold / s.acquisitions : 0;
+        snprintf(line, sizeof(line), "%-24s %12llu %12llu %6.2f%% %8lluus %8lluus %8lluus %8lluus\n",
+                 s.name.c_str(),
+                 static_cast<unsigned long long>(s.acquisitions),
+                 static_cast<unsigned long long>(s.contentions),
+                 percent,
+                 avgWait, static_cast<unsigned long long>(s.maxWait),
+                 avgHold, static_cast<unsigned long long>(s.maxHold));
+        result += line;
+    }
+    return result;
+}
+
+void MutexProfiler::reset()
+{
+    Registry &r = registry();
+    LockGuard<FastMutex> guard(&r.mutex);
+    for (std::map<std::string, Profile*>::iterator it = r.profiles.begin(); it != r.profiles.end(); ++it) {
+        it->second->clear();
+    }
+}
+
+MutexProfiler::Profile* MutexProfiler::profile(const char *pName)
+{
+    std::string name = pName != 0 ? pName : "unnamed";
+
+    Registry &r = registry();
+    LockGuard<FastMutex> guard(&r.mutex);
+    Profile *&pProfile = r.profiles[name];
+    if (pProfile == 0) {
+        pProfile = new Profile(name);
+    }
+    return pProfile;
+}
+
+void MutexProfiler::recordAcquisition(Profile *pProfile, uint64_t wait, bool contended)
+{
+    pProfile->acquisitions.fetch_add(1, std::memory_order_relaxed);
+    if (contended) {
+        pProfile->contentions.fetch_add(1, std::memory_order_relaxed);
+        pProfile->totalWait.fetch_add(wait, std::memory_order_relaxed);
+        pProfile->waitHistogram[bucket(wait)].fetch_add(1, std::memory_order_relaxed);
+        updateMax(pProfile->maxWait, wait);
+    }
+}
+
+void MutexProfiler::recordHold(Profile *pProfile, uint64_t hold)
+{
+    pProfile->totalHold.fetch_add(hold, std::memory_order_relaxed);
+    pProfile->holdHistogram[bucket(hold)].fetch_add(1, std::memory_order_relaxed);
+    updateMax(pProfile->maxHold, hold);
+}
+
+} // namespace ucxx
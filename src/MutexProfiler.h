@@ -0,0 +1,92 @@
+#ifndef UCXX_MUTEXPROFILER_H
+#define UCXX_MUTEXPROFILER_H
+
+//
+// Lock contention profiling of Mutex
+//
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ucxx {
+
+/**
+ * @brief Contention statistics of all mutexes sharing a name.
+ * Times are in microseconds. Histogram bucket i counts the durations
+ * shorter than 2^i microseconds (and not counted in a lower bucket),
+ * the last bucket counts all longer ones.
+ */
+struct MutexStatistics
+{
+    static const unsigned HistogramSize = 24;
+
+    std::string name;                       ///< Mutex name.
+    uint64_t acquisitions;                  ///< Number of locks (recursive ones excluded).
+    uint64_t contentions;                   ///< Locks which had to wait for another thread.
+    uint64_t totalWait;                     ///< Total time spent waiting for the mutex.
+    uint64_t maxWait;                       ///< Longest wait.
+    uint64_t totalHold;                     ///< Total time the mutex was held.
+    uint64_t maxHold;                       ///< Longest hold.
+    uint64_t waitHistogram[HistogramSize];  ///< Distribution of contended waits.
+    uint64_t holdHistogram[HistogramSize];  ///< Distribution of holds.
+};
+
+/**
+ * @brief Registry of mutex contention statistics.
+ * Profiling is enabled by building the library with UCXX_MUTEX_PROFILING
+ * defined (make MUTEX_PROFILING=1). Mutex::lock() then first tries to
+ * acquire the mutex without blocking, and only a failed attempt is
+ * timed as a contended acquisition; the time between the outermost
+ * lock and unlock is recorded as hold time, except time spent in
+ * ConditionVariable::wait(), which is no new acquisition when it takes
+ * the mutex back. Statistics are aggregated per mutex name given to the
+ * Mutex constructor, unnamed mutexes share one entry.
+ * Without the flag Mutex is not instrumented at all, and the registry
+ * is always empty.
+ */
+class MutexProfiler
+{
+public:
+
+    /**
+     * @brief Returns true if the library has been built with profiling.
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief Copy statistics of all mutex names.
+     * @param statistics Vector receiving the statistics, sorted by total wait time.
+     */
+    static void snapshot(std::vector<MutexStatistics> &statistics);
+
+    /**
+     * @brief Format statistics of all mutex names as a text table.
+     */
+    static std::string dump();
+
+    /**
+     * @brief Reset all statistics to zero.
+     */
+    static void reset();
+
+private:
+
+    friend class Mutex;
+
+    /// Statistics of one mutex name, shared by all mutexes of that name.
+    struct Profile;
+    struct Registry;
+
+    MutexProfiler();
+
+    static Registry& registry();
+
+    static Profile* profile(const char *pName);
+    static void recordAcquisition(Profile *pProfile, uint64_t wait, bool contended);
+    static void recordHold(Profile *pProfile, uint64_t hold);
+};
+
+} // namespace ucxx
+
+#endif // UCXX_MUTEXPROFILER_H
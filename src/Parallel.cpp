@@ -0,0 +1,62 @@
+#include <atomic>
+#include "Latch.h"
+#include "Parallel.h"
+
+namespace ucxx {
+
+void parallelChunks(size_t chunkCount, const std::function<void(size_t)> &body, ThreadPool *pPool)
+{
+    if (pPool == 0) {
+        pPool = &ThreadPool::global();
+    }
+
+    // The calling thread takes part, one helper per worker is enough
+    size_t helperCount = chunkCount > 0 ? chunkCount - 1 : 0;
+    if (helperCount > pPool->threadCount()) {
+        helperCount = pPool->threadCount();
+    }
+    if (helperCount == 0) {
+        for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+            body(chunk);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    Latch done(static_cast<unsigned>(helperCount));
+    auto run = [&next, chunkCount, &body]() {
+        size_t chunk;
+        while ((chunk = next.fetch_add(1, std::memory_order_relaxed)) < chunkCount) {
+            body(chunk);
+        }
+    };
+
+    for (size_t i = 0; i < helperCount; i++) {
+        pPool->submit([&run, &done]() {
+            run();
+            done.countDown();
+        });
+    }
+    run();
+
+    // Helpers reference this frame, wait for all of them, including those
+    // not started yet; running pending tasks meanwhile avoids deadlocking
+    // when all workers wait like this.
+    while (!done.tryWait()) {
+        if (!pPool->runPendingTask()) {
+            done.wait(1);
+        }
+    }
+}
+
+size_t defaultGrainSize(size_t count, ThreadPool *pPool)
+{
+    if (pPool == 0) {
+        pPool = &ThreadPool::global();
+    }
+    size_t chunks = static_cast<size_t>(pPool->threadCount() + 1) * 8;
+    size_t grain = count / chunks;
+    return grain > 0 ? grain : 1;
+}
+
+} // namespace ucxx
@@ -0,0 +1,187 @@
+#ifndef UCXX_PARALLEL_H
+#define UCXX_PARALLEL_H
+
+//
+// Data-parallel algorithms over a thread pool
+//
+
+#include <stddef.h>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <vector>
+#include "ThreadPool.h"
+
+namespace ucxx {
+
+/**
+ * @brief Run chunks of a job in parallel.
+ * This is the scheduling core of parallelFor(), parallelReduce() and
+ * parallelSort(). Chunks are claimed dynamically from a shared counter by
+ * the calling thread and by helper tasks submitted to the pool (at most one
+ * per worker), so faster threads take more chunks. Helper tasks spread over
+ * the workers by work stealing. While waiting for helpers to finish, the
+ * calling thread executes pending tasks of the pool, which makes it safe to
+ * call from within a task of the same pool (nested parallelism).
+ * @param chunkCount Number of chunks.
+ * @param body Function called with the chunk index, 0 to chunkCount - 1.
+ * Chunks run concurrently and in no particular order.
+ * @param pPool Pool, null for ThreadPool::global().
+ */
+void parallelChunks(size_t chunkCount, const std::function<void(size_t)> &body, ThreadPool *pPool = 0);
+
+/**
+ * @brief Returns the chunk size used when 0 is passed as grain size.
+ * Aims at several chunks per thread, to balance uneven chunk costs.
+ */
+size_t defaultGrainSize(size_t count, ThreadPool *pPool = 0);
+
+/**
+ * @brief Call a function for each index of a range in parallel.
+ * The range is split into chunks of consecutive indexes, each chunk is
+ * processed by one thread in ascending order.
+ * @param begin First index.
+ * @param end Index past the last one.
+ * @param grain Number of indexes per chunk, 0 to choose automatically.
+ * A chunk should take at least some microseconds to amortize scheduling.
+ * @param function Callable invoked with each index (size_t).
+ * @param pPool Pool, null for ThreadPool::global().
+ */
+template <typename F>
+void parallelFor(size_t begin, size_t end, size_t grain, F function, ThreadPool *pPool = 0)
+{
+    if (end <= begin) {
+        return;
+    }
+    size_t count = end - begin;
+    if (grain == 0) {
+        grain = defaultGrainSize(count, pPool);
+    }
+    size_t chunkCount = (count + grain - 1) / grain;
+    parallelChunks(chunkCount, [begin, end, grain, &function](size_t chunk) {
+        size_t first = begin + chunk * grain;
+        size_t last = end - first > grain ? first + grain : end;
+        for (size_t i = first; i < last; i++) {
+            function(i);
+        }
+    }, pPool);
+}
+
+/**
+ * @brief Chunk result of parallelReduce().
+ * Each result gets its own element (std::vector<bool> would pack them into
+ * shared words) and the padding keeps results of different threads off
+ * the same cache line.
+ */
+template <typename T>
+struct ReducePartial
+{
+    T value;
+    char padding[64];
+
+    explicit ReducePartial(const T &t) : value(t) {}
+};
+
+/**
+ * @brief Reduce a range of indexes in parallel.
+ * Each chunk is reduced by one thread starting from the identity, chunk
+ * results are then combined in index order, so the combining function
+ * needs to be associative but not commutative. The identity must not
+ * change the other operand of the combining function.
+ * @param begin First index.
+ * @param end Index past the last one.
+ * @param grain Number of indexes per chunk, 0 to choose automatically.
+ * @param identity Initial value of each chunk, and the result of an empty range.
+ * @param map Callable returning the value of an index, T map(size_t).
+ * @param combine Callable combining two values, T combine(const T&, const T&).
+ * @param pPool Pool, null for ThreadPool::global().
+ * @return Combined value of all indexes.
+ */
+template <typename T, typename M, typename C>
+T parallelReduce(size_t begin, size_t end, size_t grain, const T &identity, M map, C combine, ThreadPool *pPool = 0)
+{
+    if (end <= begin) {
+        return identity;
+    }
+    size_t count = end - begin;
+    if (grain == 0) {
+        grain = defaultGrainSize(count, pPool);
+    }
+    size_t chunkCount = (count + grain - 1) / grain;
+    std::vector<ReducePartial<T> > partials(chunkCount, ReducePartial<T>(identity));
+    parallelChunks(chunkCount, [begin, end, grain, &map, &combine, &partials](size_t chunk) {
+        size_t first = begin + chunk * grain;
+        size_t last = end - first > grain ? first + grain : end;
+        T value = partials[chunk].value;
+        for (size_t i = first; i < last; i++) {
+            value = combine(value, map(i));
+        }
+        partials[chunk].value = value;
+    }, pPool);
+
+    T result = partials[0].value;
+    for (size_t i = 1; i < chunkCount; i++) {
+        result = combine(result, partials[i].value);
+    }
+    return result;
+}
+
+/**
+ * @brief Sort a range in parallel.
+ * The range is split into chunks sorted concurrently by std::sort, sorted
+ * runs are then merged pairwise, the merges of each round running in
+ * parallel. Like std::sort, the sort is not stable.
+ * @param first Random access iterator to the first element.
+ * @param last Iterator past the last element.
+ * @param compare Strict weak ordering, bool compare(const T&, const T&).
+ * @param grain Minimum number of elements per chunk, 0 to choose automatically.
+ * @param pPool Pool, null for ThreadPool::global().
+ */
+template <typename RandomIt, typename Compare>
+void parallelSort(RandomIt first, RandomIt last, Compare compare, size_t grain = 0, ThreadPool *pPool = 0)
+{
+    size_t count = static_cast<size_t>(last - first);
+    if (grain == 0) {
+        // Big enough for the sort to outweigh the scheduling
+        grain = std::max<size_t>(defaultGrainSize(count, pPool), 4096);
+    }
+    if (count <= grain) {
+        std::sort(first, last, compare);
+        return;
+    }
+
+    size_t chunkCount = (count + grain - 1) / grain;
+    parallelChunks(chunkCount, [first, count, grain, &compare](size_t chunk) {
+        size_t begin = chunk * grain;
+        size_t end = count - begin > grain ? begin + grain : count;
+        std::sort(first + begin, first + end, compare);
+    }, pPool);
+
+    // Each round merges pairs of adjacent runs of the given width
+    for (size_t width = grain; width < count; width *= 2) {
+        size_t pairCount = (count + 2 * width - 1) / (2 * width);
+        parallelChunks(pairCount, [first, count, width, &compare](size_t pair) {
+            size_t begin = pair * 2 * width;
+            if (count - begin <= width) {
+                return;
+            }
+            size_t middle = begin + width;
+            size_t end = count - middle > width ? middle + width : count;
+            std::inplace_merge(first + begin, first + middle, first + end, compare);
+        }, pPool);
+    }
+}
+
+/**
+ * @brief Sort a range in parallel in ascending order (operator <).
+ */
+template <typename RandomIt>
+void parallelSort(RandomIt first, RandomIt last)
+{
+    typedef typename std::iterator_traits<RandomIt>::value_type T;
+    parallelSort(first, last, std::less<T>());
+}
+
+} // namespace ucxx
+
+#endif // UCXX_PARALLEL_H
@@ -5,25 +5,129 @@
 // Thread-safe queue
 //
 
+#include <stdint.h>
+#include <queue>
+#include "Mutex.h"
+#include "Sema.h"
+#include "Clock.h"
+
 namespace ucxx {
 
-#ifndef QUEUE_H
-#define QUEUE_H
+/**
+ * @brief Default item weight, every item weighs one unit.
+ */
+struct UnitWeight
+{
+    template <typename T>
+    size_t operator ()(const T&) const { return 1; }
+};
 
-#include <queue>
-#include "Mutex.h"
-#include "Semaphore.h"
+/**
+ * @brief Queue fill level notifications.
+ * Methods are called with the queue locked, they should only record the
+ * state (e.g. set a flag throttling producers) and must not block or
+ * wait on the queue.
+ */
+class IQueueListener
+{
+public:
+
+    /**
+     * @brief Queue weight has risen to the high watermark.
+     */
+    virtual void onHighWatermark() = 0;
+
+    /**
+     * @brief Queue weight has fallen to the low watermark after having
+     * reached the high one.
+     */
+    virtual void onLowWatermark() = 0;
+
+    virtual ~IQueueListener() {}
+};
 
 /**
  * @brief Thread safe queue
+ * The semaphore is only notified for consumers actually waiting, so
+ * enqueuing into a queue nobody waits on costs no system call, and a batch
+ * wakes at most as many consumers as it has items.
+ *
+ * The queue is unbounded unless limited with setCapacity(), either by
+ * number of items or by total weight of items as measured by W (e.g. a
+ * functor returning the byte size of a message; it must return the same
+ * weight for an item whenever called). What happens to an item not fitting
+ * into a full queue is set by the overflow policy. An item heavier than
+ * the weight limit is still accepted into an empty queue.
  */
-template <typename T>
+template <typename T, typename W = UnitWeight>
 class Queue
 {
 public:
-    Queue() {}
+
+    /// Handling of items enqueued into a full queue.
+    enum OverflowPolicy {
+        Overflow_Block,         ///< Wait for room.
+        Overflow_Fail,          ///< Reject the item.
+        Overflow_DropOldest     ///< Dequeue and discard the oldest items.
+    };
+
+    /**
+     * @brief Construct an unbounded queue.
+     * @param weight Item weight functor.
+     */
+    explicit Queue(const W &weight = W())
+        : m_mutex("Queue"),
+          m_weight(weight),
+          m_maxCount(0),
+          m_maxWeight(0),
+          m_policy(Overflow_Block),
+          m_totalWeight(0),
+          m_highWatermark(0),
+          m_lowWatermark(0),
+          m_pListener(0),
+          m_aboveWatermark(false),
+          m_droppedCount(0),
+          m_waiting(0),
+          m_waitingProducers(0)
+    {
+    }
+
     ~Queue() {}
 
+    /**
+     * @brief Limit the queue size.
+     * @param maxCount Maximum number of items, 0 for no limit.
+     * @param maxWeight Maximum total weight of items, 0 for no limit.
+     * @param policy Handling of items not fitting into the queue.
+     */
+    void setCapacity(size_t maxCount, size_t maxWeight = 0, OverflowPolicy policy = Overflow_Block)
+    {
+        MutexLocker locker(&m_mutex);
+        m_maxCount = maxCount;
+        m_maxWeight = maxWeight;
+        m_policy = policy;
+        // Producers blocked by the previous limits check the new ones
+        wakeProducers(m_waitingProducers);
+    }
+
+    /**
+     * @brief Set fill level notifications.
+     * The listener is notified once the total weight rises to the high
+     * watermark, and then once it falls to the low watermark.
+     * @param highWatermark High watermark, 0 disables notifications.
+     * @param lowWatermark Low watermark, lower than the high one.
+     * @param pListener Listener, not owned by the queue.
+     */
+    void setWatermarks(size_t highWatermark, size_t lowWatermark, IQueueListener *pListener)
+    {
+        MutexLocker locker(&m_mutex);
+        m_highWatermark = highWatermark;
+        m_lowWatermark = lowWatermark;
+        m_pListener = pListener;
+        m_aboveWatermark = false;
+        checkHighWatermark();
+    }
+
     /**
      * @brief Dequeue a single item from the queue.
      * @note This method will block if the queue is empty.
@@ -31,24 +135,118 @@ public:
      */
     T dequeue()
     {
-        // Wait for data in the queue
-        m_semaphore.wait();
         MutexLocker locker(&m_mutex);
+        waitForItems(0);
         T element = m_queue.front();
-        m_queue.pop();
+        pop();
+        itemsRemoved(1);
         return element;
     }
 
+    /**
+     * @brief Dequeue a single item if there is any.
+     * @param t Item dequeued.
+     * @return false if the queue is empty.
+     */
+    bool tryDequeue(T &t)
+    {
+        MutexLocker locker(&m_mutex);
+        if (m_queue.empty()) {
+            return false;
+        }
+        t = m_queue.front();
+        pop();
+        itemsRemoved(1);
+        return true;
+    }
+
+    /**
+     * @brief Dequeue up to given number of items.
+     * Waits until at least one item is available, then takes as many
+     * items as there are, up to the limit, under a single lock.
+     * @param out Output iterator receiving the items.
+     * @param max Maximum number of items to dequeue.
+     * @param milliseconds Waiting timeout, 0 to wait forever.
+     * @return Number of items dequeued, 0 on timeout.
+     */
+    template <typename OutputIterator>
+    size_t dequeueBatch(OutputIterator out, size_t max, unsigned milliseconds = 0)
+    {
+        MutexLocker locker(&m_mutex);
+        if (max == 0 || !waitForItems(milliseconds)) {
+            return 0;
+        }
+        size_t count = 0;
+        while (count < max && !m_queue.empty()) {
+            *out++ = m_queue.front();
+            pop();
+            count++;
+        }
+        itemsRemoved(count);
+        return count;
+    }
+
     /**
      * @brief Enqueue an item.
-     * @note This will notify on queue's semaphore.
+     * @note This will notify on queue's semaphore if a consumer waits.
+     * With the blocking overflow policy this method blocks while the
+     * queue is full.
      * @param t Item to be enqueued.
+     * @return false if the item has been rejected by the failing policy.
      */
-    void enqueue(const T &t)
+    bool enqueue(const T &t)
+    {
+        return enqueue(t, 0);
+    }
+
+    /**
+     * @brief Enqueue an item, waiting for room at most given time.
+     * @param t Item to be enqueued.
+     * @param milliseconds Waiting timeout, 0 to wait forever.
+     * @return false on timeout or if the item has been rejected.
+     */
+    bool enqueue(const T &t, unsigned milliseconds)
     {
         MutexLocker locker(&m_mutex);
-        m_queue.push(t);
-        m_semaphore.notify(1);
+        if (!makeRoom(m_weight(t), milliseconds)) {
+            return false;
+        }
+        push(t);
+        wakeConsumers(1);
+        return true;
+    }
+
+    /**
+     * @brief Enqueue a range of items under a single lock.
+     * With the blocking overflow policy the lock is released while waiting
+     * for room, with the failing policy enqueuing stops at the first item
+     * not fitting.
+     * @param first Iterator to the first item.
+     * @param last Iterator past the last item.
+     * @return Number of items enqueued.
+     */
+    template <typename InputIterator>
+    size_t enqueueBatch(InputIterator first, InputIterator last)
+    {
+        MutexLocker locker(&m_mutex);
+        size_t count = 0;
+        size_t pending = 0;
+        for (; first != last; ++first) {
+            size_t weight = m_weight(*first);
+            if (!fits(weight)) {
+                // Consumers have to know about the items before we wait for them
+                wakeConsumers(pending);
+                pending = 0;
+                if (!makeRoom(weight, 0)) {
+                    break;
+                }
+            }
+            push(*first);
+            count++;
+            pending++;
+        }
+        wakeConsumers(pending);
+        return count;
     }
 
     /**
@@ -71,26 +269,209 @@ public:
         return m_queue.size();
     }
 
+    /**
+     * @brief Returns total weight of items in the queue.
+     */
+    size_t weight() const
+    {
+        MutexLocker locker(&m_mutex);
+        return m_totalWeight;
+    }
+
+    /**
+     * @brief Returns number of items discarded by the drop-oldest policy.
+     */
+    uint64_t droppedCount() const
+    {
+        MutexLocker locker(&m_mutex);
+        return m_droppedCount;
+    }
+
     /**
      * @brief Clear the queue.
      */
     void clear()
     {
         MutexLocker locker(&m_mutex);
-        for (int i = 0; i < m_queue.size(); ++i) {
-            // Synchronize with the semaphore counter.
-            m_semaphore.wait();
-        }
+        size_t count = m_queue.size();
         m_queue = std::queue<T>();
+        m_totalWeight = 0;
+        itemsRemoved(count);
     }
 
 private:
 
+    // Disable copying
+    Queue(const Queue&);
+    Queue& operator =(const Queue&);
+
+    // Following methods are called with the mutex locked.
+
+    void push(const T &t)
+    {
+        m_queue.push(t);
+        m_totalWeight += m_weight(t);
+        checkHighWatermark();
+    }
+
+    void pop()
+    {
+        m_totalWeight -= m_weight(m_queue.front());
+        m_queue.pop();
+    }
+
+    bool fits(size_t weight) const
+    {
+        if (m_queue.empty()) {
+            return true;
+        }
+        if (m_maxCount > 0 && m_queue.size() >= m_maxCount) {
+            return false;
+        }
+        return m_maxWeight == 0 || m_totalWeight + weight <= m_maxWeight;
+    }
+
+    // Apply the overflow policy, returns false if the item is not to be enqueued.
+    bool makeRoom(size_t weight, unsigned milliseconds)
+    {
+        if (fits(weight)) {
+            return true;
+        }
+
+        switch (m_policy) {
+        case Overflow_Fail:
+            return false;
+
+        case Overflow_DropOldest: {
+            size_t count = 0;
+            while (!fits(weight)) {
+                pop();
+                count++;
+            }
+            m_droppedCount += count;
+            itemsRemoved(count);
+            return true;
+        }
+
+        default:
+            break;
+        }
+
+        uint64_t deadline = Clock::milliseconds() + milliseconds;
+        while (!fits(weight)) {
+            if (!sleep(m_producerSemaphore, m_waitingProducers, milliseconds, deadline)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void itemsRemoved(size_t count)
+    {
+        if (count == 0) {
+            return;
+        }
+        wakeProducers(count);
+        if (m_aboveWatermark && m_totalWeight <= m_lowWatermark) {
+            m_aboveWatermark = false;
+            m_pListener->onLowWatermark();
+        }
+    }
+
+    void checkHighWatermark()
+    {
+        if (!m_aboveWatermark && m_pListener != 0 && m_highWatermark > 0 && m_totalWeight >= m_highWatermark) {
+            m_aboveWatermark = true;
+            m_pListener->onHighWatermark();
+        }
+    }
+
+    /*
+     * Waiting consumers (producers) are counted in m_waiting
+     * (m_waitingProducers). A thread waking them takes them off the counter,
+     * so each waiting thread gets exactly one notification. A thread leaving
+     * on timeout takes itself off, unless it has already been taken off, in
+     * which case it consumes the notification on its way.
+     */
+
+    // Returns false on timeout.
+    bool waitForItems(unsigned milliseconds)
+    {
+        uint64_t deadline = Clock::milliseconds() + milliseconds;
+        while (m_queue.empty()) {
+            if (!sleep(m_semaphore, m_waiting, milliseconds, deadline)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Wait for a single notification, returns false once the deadline has passed.
+    bool sleep(Semaphore &semaphore, size_t &waiting, unsigned milliseconds, uint64_t deadline)
+    {
+        unsigned timeout = 0;
+        if (milliseconds > 0) {
+            timeout = Clock::remaining(deadline);
+            if (timeout == 0) {
+                return false;
+            }
+        }
+
+        waiting++;
+        m_mutex.unlock();
+        bool notified = semaphore.wait(timeout);
+        m_mutex.lock();
+        if (!notified) {
+            if (waiting > 0) {
+                waiting--;
+            } else {
+                m_mutex.unlock();
+                semaphore.wait();
+                m_mutex.lock();
+            }
+        }
+        return true;
+    }
+
+    void wakeConsumers(size_t count)
+    {
+        wake(m_semaphore, m_waiting, count);
+    }
+
+    void wakeProducers(size_t count)
+    {
+        wake(m_producerSemaphore, m_waitingProducers, count);
+    }
+
+    static void wake(Semaphore &semaphore, size_t &waiting, size_t count)
+    {
+        if (count > waiting) {
+            count = waiting;
+        }
+        if (count > 0) {
+            waiting -= count;
+            semaphore.notify(static_cast<int>(count));
+        }
+    }
+
     mutable Mutex m_mutex;
-    Semaphore m_semaphore;
+    W m_weight;                 ///< Item weight functor.
+    size_t m_maxCount;          ///< Maximum number of items, 0 if unlimited.
+    size_t m_maxWeight;         ///< Maximum total weight, 0 if unlimited.
+    OverflowPolicy m_policy;    ///< Handling of items not fitting.
+    size_t m_totalWeight;       ///< Total weight of queued items.
+    size_t m_highWatermark;     ///< Weight triggering the high watermark notification.
+    size_t m_lowWatermark;      ///< Weight triggering the low watermark notification.
+    IQueueListener *m_pListener;    ///< Fill level listener.
+    bool m_aboveWatermark;      ///< High watermark reached and low one not yet.
+    uint64_t m_droppedCount;    ///< Items discarded on overflow.
+    Semaphore m_semaphore;      ///< Waiting consumers sleep here.
+    Semaphore m_producerSemaphore;  ///< Producers waiting for room sleep here.
+    size_t m_waiting;           ///< Consumers waiting and not notified yet.
+    size_t m_waitingProducers;  ///< Producers waiting and not notified yet.
     std::queue<T> m_queue;
 };
 
-} // ucxx
+} // namespace ucxx
 
 #endif // UCXX_QUEUE_H
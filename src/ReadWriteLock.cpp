@@ -0,0 +1,64 @@
+#include "ReadWriteLock.h"
+
+namespace ucxx {
+
+ReadWriteLock::ReadWriteLock()
+{
+#ifdef WIN32
+    InitializeSRWLock(&m_lock);
+#else
+    pthread_rwlockattr_t attr;
+    pthread_rwlockattr_init(&attr);
+#if defined(__GLIBC__)
+    // glibc prefers readers by default, which may starve writers
+    pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+    pthread_rwlock_init(&m_lock, &attr);
+    pthread_rwlockattr_destroy(&attr);
+#endif
+}
+
+ReadWriteLock::~ReadWriteLock()
+{
+#ifndef WIN32
+    pthread_rwlock_destroy(&m_lock);
+#endif
+}
+
+void ReadWriteLock::lockRead()
+{
+#ifdef WIN32
+    AcquireSRWLockShared(&m_lock);
+#else
+    pthread_rwlock_rdlock(&m_lock);
+#endif
+}
+
+void ReadWriteLock::lockWrite()
+{
+#ifdef WIN32
+    AcquireSRWLockExclusive(&m_lock);
+#else
+    pthread_rwlock_wrlock(&m_lock);
+#endif
+}
+
+void ReadWriteLock::unlockRead()
+{
+#ifdef WIN32
+    ReleaseSRWLockShared(&m_lock);
+#else
+    pthread_rwlock_unlock(&m_lock);
+#endif
+}
+
+void ReadWriteLock::unlockWrite()
+{
+#ifdef WIN32
+    ReleaseSRWLockExclusive(&m_lock);
+#else
+    pthread_rwlock_unlock(&m_lock);
+#endif
+}
+
+} // namespace ucxx
@@ -0,0 +1,136 @@
+#ifndef UCXX_READWRITELOCK_H
+#define UCXX_READWRITELOCK_H
+
+//
+// System-specific reader-writer lock implementation
+//
+
+#ifdef WIN32
+#   include <Windows.h>
+#else
+#   include <pthread.h>
+#endif
+
+namespace ucxx {
+
+/**
+ * @brief Platform-specific reader-writer lock.
+ * Any number of readers may hold the lock at the same time, a writer
+ * holds it exclusively. Waiting writers take precedence over new readers,
+ * so a steady stream of readers cannot starve a writer; for the same
+ * reason the lock is not recursive, not even for readers.
+ */
+class ReadWriteLock
+{
+public:
+
+    /**
+     * @brief Construct an unlocked lock.
+     */
+    ReadWriteLock();
+
+    ~ReadWriteLock();
+
+    /**
+     * @brief Acquire the lock for reading.
+     * This method will block while a writer holds or waits for the lock.
+     */
+    void lockRead();
+
+    /**
+     * @brief Acquire the lock for writing.
+     * This method will block while any other thread holds the lock.
+     */
+    void lockWrite();
+
+    /**
+     * @brief Release the lock acquired for reading.
+     */
+    void unlockRead();
+
+    /**
+     * @brief Release the lock acquired for writing.
+     */
+    void unlockWrite();
+
+private:
+
+    // Disable copying
+    ReadWriteLock(const ReadWriteLock&);
+    ReadWriteLock& operator =(const ReadWriteLock&);
+
+    /// Platform-specific lock implementation.
+#ifdef WIN32
+    SRWLOCK m_lock;
+#else
+    pthread_rwlock_t m_lock;
+#endif
+};
+
+/**
+ * @brief Read lock helper class.
+ * Releases the lock when the locker's instance goes out of scope.
+ */
+class ReadLocker
+{
+public:
+
+    /**
+     * @brief Construct the locker, locking for reading.
+     * @param pLock Pointer to the lock to be locked.
+     */
+    explicit ReadLocker(ReadWriteLock *pLock)
+        : m_pLock(pLock)
+    {
+        m_pLock->lockRead();
+    }
+
+    ~ReadLocker()
+    {
+        m_pLock->unlockRead();
+    }
+
+private:
+
+    // Disable copying
+    ReadLocker(const ReadLocker&);
+    ReadLocker& operator =(const ReadLocker&);
+
+    ReadWriteLock *m_pLock;
+};
+
+/**
+ * @brief Write lock helper class.
+ * Releases the lock when the locker's instance goes out of scope.
+ */
+class WriteLocker
+{
+public:
+
+    /**
+     * @brief Construct the locker, locking for writing.
+     * @param pLock Pointer to the lock to be locked.
+     */
+    explicit WriteLocker(ReadWriteLock *pLock)
+        : m_pLock(pLock)
+    {
+        m_pLock->lockWrite();
+    }
+
+    ~WriteLocker()
+    {
+        m_pLock->unlockWrite();
+    }
+
+private:
+
+    // Disable copying
+    WriteLocker(const WriteLocker&);
+    WriteLocker& operator =(const WriteLocker&);
+
+    ReadWriteLock *m_pLock;
+};
+
+} // namespace ucxx
+
+#endif // UCXX_READWRITELOCK_H
@@ -5,6 +5,11 @@
 #else
 #   ifdef __APPLE__
 #      include <sys/time.h>
+#   elif defined __linux__
+#      include <linux/futex.h>
+#      include <sys/syscall.h>
+#      include <unistd.h>
+#      include "Clock.h"
 #   endif
 #   include <time.h>
 #   include <errno.h>
@@ -16,6 +21,21 @@
 
 namespace ucxx {
 
+#if !defined WIN32 && !defined __APPLE__ && defined __linux__
+
+namespace {
+
+// Spinning only pays off when the notifying thread runs on another processor
+int spinCount(int count)
+{
+    static const bool multiprocessor = sysconf(_SC_NPROCESSORS_ONLN) > 1;
+    return multiprocessor ? count : 0;
+}
+
+} // namespace
+
+#endif
+
 Semaphore::Semaphore(int value)
 {
 #ifdef WIN32
@@ -28,6 +48,9 @@ Semaphore::Semaphore(int value)
     pthread_mutex_init(&m_waitMutex, 0);
     pthread_cond_init(&m_waitCond, 0);
     m_count = value;
+#elif defined __linux__
+    m_count.store(value);
+    m_waiters.store(0);
 #else
     memset(&m_semaphore, 0, sizeof(sem_t));
     sem_init(&m_semaphore, 0, value);
@@ -43,6 +66,8 @@ Semaphore::~Semaphore()
     pthread_mutex_destroy(&m_countMutex);
     pthread_mutex_destroy(&m_waitMutex);
     pthread_cond_destroy(&m_waitCond);
+#elif defined __linux__
+    // Nothing to release
 #else
     sem_destroy(&m_semaphore);
 #endif
@@ -102,6 +127,48 @@ bool Semaphore::wait(unsigned int milliseconds)
     }
     return false;
 
+#elif defined __linux__
+
+    if (tryDecrement()) {
+        return true;
+    }
+    for (int i = spinCount(SpinCount); i > 0; i--) {
+        if (tryDecrement()) {
+            return true;
+        }
+#   if defined __i386__ || defined __x86_64__
+        __builtin_ia32_pause();
+#   endif
+    }
+
+    uint64_t deadline = Clock::milliseconds() + milliseconds;
+    for (;;) {
+        // Announce the sleep before checking the counter, see notify()
+        m_waiters.fetch_add(1);
+        if (tryDecrement()) {
+            m_waiters.fetch_sub(1);
+            return true;
+        }
+
+        struct timespec ts;
+        struct timespec *pTimeout = 0;
+        if (milliseconds > 0) {
+            unsigned remaining = Clock::remaining(deadline);
+            if (remaining == 0) {
+                m_waiters.fetch_sub(1);
+                return false;
+            }
+            ts.tv_sec = remaining / 1000;
+            ts.tv_nsec = (remaining % 1000) * 1000000;
+            pTimeout = &ts;
+        }
+
+        // Sleeps only if the counter is still zero, returns on notify(),
+        // timeout or a signal; all of them are handled by looping again.
+        syscall(SYS_futex, reinterpret_cast<int*>(&m_count), FUTEX_WAIT_PRIVATE, 0, pTimeout, 0, 0);
+        m_waiters.fetch_sub(1);
+    }
+
 #else
 
     if (milliseconds == 0) {
@@ -146,6 +213,8 @@ int Semaphore::value()
     pthread_mutex_lock(&m_countMutex);
     cnt = m_count;
     pthread_mutex_unlock(&m_countMutex);
+#elif defined __linux__
+    cnt = m_count.load(std::memory_order_relaxed);
 #else
     sem_getvalue(&m_semaphore, &cnt);
 #endif
@@ -160,6 +229,15 @@ void Semaphore::notify(int increment)
     ReleaseSemaphore(m_semaphore, increment, &cnt);
     m_count = cnt + increment;
     m_pMutex->unlock();
+#elif defined __linux__
+    m_count.fetch_add(increment);
+    // Pairs with the waiter count increment in wait(): either a thread going
+    // to sleep sees the new counter, or we see the thread and wake it up.
+    int waiters = m_waiters.load();
+    if (waiters > 0) {
+        syscall(SYS_futex, reinterpret_cast<int*>(&m_count), FUTEX_WAKE_PRIVATE,
+                increment < waiters ? increment : waiters, 0, 0, 0);
+    }
 #else
     // Is there more efficient way to do this?
     for (int i = 0; i < increment; i++) {
@@ -175,4 +253,19 @@ void Semaphore::notify(int increment)
 #endif
 }
 
+#if !defined WIN32 && !defined __APPLE__ && defined __linux__
+
+bool Semaphore::tryDecrement()
+{
+    int count = m_count.load();
+    while (count > 0) {
+        if (m_count.compare_exchange_weak(count, count - 1, std::memory_order_acquire)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif
+
 } // namespace ucxx
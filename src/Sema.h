@@ -9,6 +9,8 @@
 #   include <Windows.h>
 #elif defined __APPLE__
 #   include <pthread.h>
+#elif defined __linux__
+#   include <atomic>
 #else
 #   include <semaphore.h>
 #endif
@@ -18,6 +20,11 @@ namespace ucxx {
 /*
  * POSIX semaphores are not fully supported by Mac OS, so we have to use
  * custom implementation here via pthread condition notification.
+ *
+ * On Linux the semaphore is implemented in user space: the counter is an
+ * atomic integer, waiting spins shortly and then sleeps on the counter with
+ * futex(2), and the kernel is only entered to wake threads actually
+ * sleeping, all of them in a single call.
  */
 
 #ifdef WIN32
@@ -81,6 +88,14 @@ private:
     pthread_mutex_t m_waitMutex;    ///< Mutex for conditional wait.
     pthread_cond_t m_waitCond;      ///< Conditional wait.
     int m_count;
+#elif defined __linux__
+    /// Number of attempts to take the semaphore before going to sleep.
+    static const int SpinCount = 100;
+
+    bool tryDecrement();
+
+    std::atomic<int> m_count;   ///< Semaphore counter, futex word.
+    std::atomic<int> m_waiters; ///< Number of threads sleeping or going to sleep.
 #else
     sem_t m_semaphore; ///< System semaphore.
 #endif
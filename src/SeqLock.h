@@ -0,0 +1,86 @@
+#ifndef UCXX_SEQLOCK_H
+#define UCXX_SEQLOCK_H
+
+//
+// Sequence lock protecting a small value
+//
+
+#include <string.h>
+#include <stdint.h>
+#include <atomic>
+#include <type_traits>
+#include "SpinLock.h"
+
+namespace ucxx {
+
+/**
+ * @brief Value readable without locking, for read-mostly state.
+ * A writer makes the sequence number odd, updates the value and makes the
+ * number even again. A reader copies the value and retries if the sequence
+ * number was odd or has changed meanwhile. Readers never write shared
+ * memory, so any number of them can read concurrently without bouncing a
+ * cache line between processors; writers are serialized with each other.
+ * Meant for small trivially copyable values (a few words) which change
+ * rarely; readers spin while a write is in progress.
+ */
+template <typename T>
+class SeqLock
+{
+public:
+
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock value must be trivially copyable");
+
+    explicit SeqLock(const T &value = T()) : m_sequence(0), m_value(value) {}
+
+    /**
+     * @brief Returns a consistent snapshot of the value.
+     */
+    T load() const
+    {
+        T value;
+        for (;;) {
+            uint32_t sequence = m_sequence.load(std::memory_order_acquire);
+            if ((sequence & 1) == 0) {
+                memcpy(&value, &m_value, sizeof(T));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (m_sequence.load(std::memory_order_relaxed) == sequence) {
+                    return value;
+                }
+            }
+            SpinLock::pause();
+        }
+    }
+
+    /**
+     * @brief Replace the value.
+     */
+    void store(const T &value)
+    {
+        // An odd sequence number also locks out other writers
+        uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+        for (;;) {
+            if ((sequence & 1) == 0 &&
+                m_sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire)) {
+                break;
+            }
+            SpinLock::pause();
+            sequence = m_sequence.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&m_value, &value, sizeof(T));
+        m_sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+private:
+
+    // Disable copying
+    SeqLock(const SeqLock&);
+    SeqLock& operator =(const SeqLock&);
+
+    std::atomic<uint32_t> m_sequence;   ///< Odd while a write is in progress.
+    T m_value;                          ///< Protected value.
+};
+
+} // namespace ucxx
+
+#endif // UCXX_SEQLOCK_H
@@ -8,13 +8,15 @@
 #include <stdlib.h>
 #include <string>
 #include "ByteArray.h"
+#include "ByteStream.h"
 
 namespace ucxx {
 
 /**
  * @brief Abstract socket implementation.
+ * A socket is both a byte sink and a byte source.
  */
-class Socket
+class Socket : public IByteSink, public IByteSource
 {
 public:
 
@@ -0,0 +1,107 @@
+#ifndef UCXX_SPINLOCK_H
+#define UCXX_SPINLOCK_H
+
+//
+// Busy-waiting lock
+//
+
+#include <atomic>
+#ifdef WIN32
+#   include <Windows.h>
+#else
+#   include <sched.h>
+#endif
+
+namespace ucxx {
+
+/**
+ * @brief Lock waiting by spinning instead of sleeping.
+ * Meant for critical sections of a few instructions, where putting a
+ * thread to sleep costs more than the wait itself. A waiting thread only
+ * reads the lock state (so the cache line is not bounced between waiters)
+ * and backs off exponentially with a processor pause between attempts;
+ * past the backoff limit it yields its time slice, so a preempted owner
+ * can finish. The lock is not recursive.
+ * Use with LockGuard<SpinLock>.
+ */
+class SpinLock
+{
+public:
+
+    SpinLock() : m_locked(false) {}
+
+    /**
+     * @brief Acquire the lock, spinning while it is held by another thread.
+     */
+    void lock()
+    {
+        unsigned backoff = 1;
+        while (m_locked.exchange(true, std::memory_order_acquire)) {
+            do {
+                if (backoff <= MaxBackoff) {
+                    for (unsigned i = 0; i < backoff; i++) {
+                        pause();
+                    }
+                    backoff <<= 1;
+                } else {
+                    yield();
+                }
+            } while (m_locked.load(std::memory_order_relaxed));
+        }
+    }
+
+    /**
+     * @brief Release the lock.
+     */
+    void unlock()
+    {
+        m_locked.store(false, std::memory_order_release);
+    }
+
+    /**
+     * @brief Attempt to acquire the lock without spinning.
+     * @return true if the lock has been acquired.
+     */
+    bool tryLock()
+    {
+        return !m_locked.load(std::memory_order_relaxed) && !m_locked.exchange(true, std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Tell the processor the calling thread is busy-waiting.
+     */
+    static void pause()
+    {
+#if defined _MSC_VER
+        YieldProcessor();
+#elif defined __i386__ || defined __x86_64__
+        __builtin_ia32_pause();
+#elif defined __aarch64__
+        __asm__ __volatile__("yield");
+#endif
+    }
+
+private:
+
+    // Disable copying
+    SpinLock(const SpinLock&);
+    SpinLock& operator =(const SpinLock&);
+
+    /// Maximum number of pauses between two attempts.
+    static const unsigned MaxBackoff = 64;
+
+    static void yield()
+    {
+#ifdef WIN32
+        SwitchToThread();
+#else
+        sched_yield();
+#endif
+    }
+
+    std::atomic<bool> m_locked;     ///< Lock state.
+};
+
+} // namespace ucxx
+
+#endif // UCXX_SPINLOCK_H
@@ -0,0 +1,281 @@
+#ifndef UCXX_SPSCQUEUE_H
+#define UCXX_SPSCQUEUE_H
+
+//
+// Wait-free bounded single-producer single-consumer queue
+//
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include "Sema.h"
+#include "Clock.h"
+
+namespace ucxx {
+
+/**
+ * @brief Bounded wait-free queue for exactly one producer and one consumer.
+ * The producer only writes the tail index, the consumer only writes the
+ * head index, so neither side ever retries or locks. Each side keeps a
+ * private copy of the other side's index and reads the shared one only
+ * when the copy says the ring is full/empty, which keeps the cache line of
+ * the other side mostly untouched.
+ * Batch operations transfer many items and publish the index once.
+ * Blocking variants spin shortly and then sleep on a semaphore, which is
+ * only notified while the other side sleeps.
+ * Using the queue from more than one producer or consumer thread at a
+ * time is undefined. T must be default-constructible and copy-assignable.
+ */
+template <typename T>
+class SpscQueue
+{
+public:
+
+    /**
+     * @brief Construct an empty queue.
+     * @param capacity Maximum number of items, rounded up to a power of two.
+     */
+    explicit SpscQueue(size_t capacity = 1024)
+        : m_tail(0), m_cachedHead(0), m_head(0), m_cachedTail(0),
+          m_producerWaiting(false), m_consumerWaiting(false)
+    {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        m_pItems = new T[size];
+        m_mask = size - 1;
+    }
+
+    ~SpscQueue()
+    {
+        delete[] m_pItems;
+    }
+
+    /**
+     * @brief Enqueue an item if there is room (producer only).
+     * @return false if the queue is full.
+     */
+    bool tryEnqueue(const T &item)
+    {
+        return tryEnqueue(&item, 1) == 1;
+    }
+
+    /**
+     * @brief Enqueue as many of given items as fit (producer only).
+     * @param pItems Items to be enqueued.
+     * @param count Number of items.
+     * @return Number of items enqueued.
+     */
+    size_t tryEnqueue(const T *pItems, size_t count)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        size_t room = m_mask + 1 - (tail - m_cachedHead);
+        if (room < count) {
+            m_cachedHead = m_head.load(std::memory_order_acquire);
+            room = m_mask + 1 - (tail - m_cachedHead);
+        }
+        if (count > room) {
+            count = room;
+        }
+        if (count == 0) {
+            return 0;
+        }
+        for (size_t i = 0; i < count; i++) {
+            m_pItems[(tail + i) & m_mask] = pItems[i];
+        }
+        m_tail.store(tail + count, std::memory_order_release);
+        wake(m_consumerWaiting, m_itemSemaphore);
+        return count;
+    }
+
+    /**
+     * @brief Dequeue an item if there is any (consumer only).
+     * @return false if the queue is empty.
+     */
+    bool tryDequeue(T &item)
+    {
+        return tryDequeue(&item, 1) == 1;
+    }
+
+    /**
+     * @brief Dequeue up to given number of items (consumer only).
+     * @param pItems Buffer receiving the items.
+     * @param maxCount Buffer size.
+     * @return Number of items dequeued.
+     */
+    size_t tryDequeue(T *pItems, size_t maxCount)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        size_t available = m_cachedTail - head;
+        if (available < maxCount) {
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+            available = m_cachedTail - head;
+        }
+        if (maxCount > available) {
+            maxCount = available;
+        }
+        if (maxCount == 0) {
+            return 0;
+        }
+        for (size_t i = 0; i < maxCount; i++) {
+            pItems[i] = m_pItems[(head + i) & m_mask];
+        }
+        m_head.store(head + maxCount, std::memory_order_release);
+        wake(m_producerWaiting, m_slotSemaphore);
+        return maxCount;
+    }
+
+    /**
+     * @brief Enqueue an item (producer only).
+     * @note This method will block while the queue is full.
+     */
+    void enqueue(const T &item)
+    {
+        enqueue(item, 0);
+    }
+
+    /**
+     * @brief Enqueue an item, waiting for room at most given time (producer only).
+     * @param item Item to be enqueued.
+     * @param milliseconds Waiting timeout, 0 to wait forever.
+     * @return false on timeout.
+     */
+    bool enqueue(const T &item, unsigned milliseconds)
+    {
+        PushOperation op(this, item);
+        return block(op, m_producerWaiting, m_slotSemaphore, milliseconds);
+    }
+
+    /**
+     * @brief Dequeue an item (consumer only).
+     * @note This method will block while the queue is empty.
+     */
+    T dequeue()
+    {
+        T item;
+        dequeue(item, 0);
+        return item;
+    }
+
+    /**
+     * @brief Dequeue an item, waiting for one at most given time (consumer only).
+     * @param item Item dequeued.
+     * @param milliseconds Waiting timeout, 0 to wait forever.
+     * @return false on timeout.
+     */
+    bool dequeue(T &item, unsigned milliseconds)
+    {
+        PopOperation op(this, item);
+        return block(op, m_consumerWaiting, m_itemSemaphore, milliseconds);
+    }
+
+    size_t capacity() const { return m_mask + 1; }
+
+    /**
+     * @brief Returns approximate number of items in the queue.
+     */
+    size_t count() const
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+private:
+
+    // Disable copying
+    SpscQueue(const SpscQueue&);
+    SpscQueue& operator =(const SpscQueue&);
+
+    /// Number of attempts before going to sleep.
+    static const int SpinCount = 100;
+
+    struct PushOperation {
+        SpscQueue *pQueue;
+        const T &item;
+        PushOperation(SpscQueue *queue, const T &t) : pQueue(queue), item(t) {}
+        bool operator ()() { return pQueue->tryEnqueue(item); }
+    };
+
+    struct PopOperation {
+        SpscQueue *pQueue;
+        T &item;
+        PopOperation(SpscQueue *queue, T &t) : pQueue(queue), item(t) {}
+        bool operator ()() { return pQueue->tryDequeue(item); }
+    };
+
+    /*
+     * Sleeping protocol: the sleeper raises its waiting flag and retries,
+     * the other side checks the flag after publishing its index. The fences
+     * make sure at least one of them notices the other. Whoever clears the
+     * flag owns the notification: the waker posts it, a sleeper leaving on
+     * its own finds the flag already cleared and consumes the posted one.
+     */
+
+    template <typename Operation>
+    bool block(Operation &op, std::atomic<bool> &waiting, Semaphore &semaphore, unsigned milliseconds)
+    {
+        for (int i = 0; i < SpinCount; i++) {
+            if (op()) {
+                return true;
+            }
+        }
+
+        uint64_t deadline = Clock::milliseconds() + milliseconds;
+        for (;;) {
+            waiting.store(true);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (op()) {
+                leave(waiting, semaphore);
+                return true;
+            }
+            unsigned timeout = 0;
+            if (milliseconds > 0) {
+                timeout = Clock::remaining(deadline);
+                if (timeout == 0) {
+                    leave(waiting, semaphore);
+                    return false;
+                }
+            }
+            if (!semaphore.wait(timeout)) {
+                leave(waiting, semaphore);
+            }
+        }
+    }
+
+    // Clear the waiting flag of a sleeper which has not been woken up.
+    void leave(std::atomic<bool> &waiting, Semaphore &semaphore)
+    {
+        if (!waiting.exchange(false)) {
+            semaphore.wait();
+        }
+    }
+
+    void wake(std::atomic<bool> &waiting, Semaphore &semaphore)
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting.load(std::memory_order_relaxed) && waiting.exchange(false)) {
+            semaphore.notify();
+        }
+    }
+
+    // Producer and consumer fields live on separate cache lines
+    char m_padding0[64];
+    std::atomic<size_t> m_tail;         ///< Next slot to write, published by the producer.
+    size_t m_cachedHead;                ///< Producer's copy of the head.
+    char m_padding1[64];
+    std::atomic<size_t> m_head;         ///< Next slot to read, published by the consumer.
+    size_t m_cachedTail;                ///< Consumer's copy of the tail.
+    char m_padding2[64];
+    T *m_pItems;                        ///< Ring of items.
+    size_t m_mask;                      ///< Ring size minus one.
+    std::atomic<bool> m_producerWaiting;    ///< Producer sleeping on a full queue.
+    std::atomic<bool> m_consumerWaiting;    ///< Consumer sleeping on an empty queue.
+    Semaphore m_slotSemaphore;          ///< Notified when slots are freed.
+    Semaphore m_itemSemaphore;          ///< Notified when items are added.
+};
+
+} // namespace ucxx
+
+#endif // UCXX_SPSCQUEUE_H
@@ -0,0 +1,404 @@
+#include <string.h>
+#include "Endian.h"
+#include "WireFormat.h"
+#include "Socket.h"
+#include "StreamSerializer.h"
+
+namespace ucxx {
+
+const size_t StreamSerializer::DefaultChunkSize;
+
+StreamSerializer::StreamSerializer(IByteSink *pSink, IByteSource *pSource, size_t chunkSize)
+    : m_pSink(pSink),
+      m_pSource(pSource),
+      m_writeBuffer(chunkSize > 0 ? chunkSize : DefaultChunkSize),
+      m_writeSize(0),
+      m_readBuffer(chunkSize > 0 ? chunkSize : DefaultChunkSize),
+      m_readIndex(0),
+      m_readSize(0),
+      m_error(false),
+      m_timedOut(false)
+{
+}
+
+StreamSerializer::StreamSerializer(Socket *pSocket, size_t chunkSize)
+    : m_pSink(pSocket),
+      m_pSource(pSocket),
+      m_writeBuffer(chunkSize > 0 ? chunkSize : DefaultChunkSize),
+      m_writeSize(0),
+      m_readBuffer(chunkSize > 0 ? chunkSize : DefaultChunkSize),
+      m_readIndex(0),
+      m_readSize(0),
+      m_error(false),
+      m_timedOut(false)
+{
+}
+
+StreamSerializer::~StreamSerializer()
+{
+    flush();
+}
+
+void StreamSerializer::pushValue(const Variant &value)
+{
+    encode(value);
+    flush();
+}
+
+void StreamSerializer::encode(const Variant &value)
+{
+    pushTypeSignature(value.type());
+
+    switch (value.type()) {
+    case Variant::Type_Boolean:
+        pushRawValue<bool>(value.toBoolean());
+        break;
+    case Variant::Type_Integer:
+        pushRawValue<int>(value.toInteger());
+        break;
+    case Variant::Type_Real:
+        pushRawValue<double>(value.toReal());
+        break;
+    case Variant::Type_String:
+        pushString(value.string());
+        break;
+    case Variant::Type_List:
+        pushList(value.list());
+        break;
+    case Variant::Type_Map:
+        pushMap(value.map());
+        break;
+    default:
+        // Null and invalid values have no payload
+        break;
+    }
+}
+
+bool StreamSerializer::popValue(Variant &value)
+{
+    // A timeout before the first byte of the value consumes nothing, later
+    // ones are waited out as the bytes read so far cannot be given back
+    m_timedOut = false;
+    if (m_readIndex == m_readSize && !fill(false)) {
+        return false;
+    }
+    return decode(value);
+}
+
+bool StreamSerializer::decode(Variant &value)
+{
+    Variant::Type type = Variant::Type_Invalid;
+    if (!popTypeSignature(type)) {
+        return false;
+    }
+
+    switch (type) {
+    case Variant::Type_Invalid:
+    case Variant::Type_Null:
+        value = Variant(type);
+        break;
+    case Variant::Type_Boolean: {
+        bool v;
+        if (!popRawValue<bool>(v)) {
+            return false;
+        }
+        value = v;
+        break;
+    }
+    case Variant::Type_Integer: {
+        int v;
+        if (!popRawValue<int>(v)) {
+            return false;
+        }
+        value = v;
+        break;
+    }
+    case Variant::Type_Real: {
+        double v;
+        if (!popRawValue<double>(v)) {
+            return false;
+        }
+        value = v;
+        break;
+    }
+    case Variant::Type_String: {
+        // Decode straight into the resulting variant to avoid copying
+        value = Variant(Variant::Type_String);
+        if (!popString(value.string())) {
+            return false;
+        }
+        break;
+    }
+    case Variant::Type_List: {
+        value = Variant(Variant::Type_List);
+        if (!popList(value.list())) {
+            return false;
+        }
+        break;
+    }
+    case Variant::Type_Map: {
+        value = Variant(Variant::Type_Map);
+        if (!popMap(value.map())) {
+            return false;
+        }
+        break;
+    }
+    default:
+        return false;
+    }
+
+    return true;
+}
+
+bool StreamSerializer::flush()
+{
+    if (m_pSink == 0) {
+        m_writeSize = 0;
+        return false;
+    }
+
+    size_t offset = 0;
+    while (offset < m_writeSize) {
+        size_t written = m_pSink->writeBuffer(&m_writeBuffer[offset], m_writeSize - offset);
+        if (written == 0) {
+            // Sink failure, pending data is discarded
+            m_error = true;
+            break;
+        }
+        offset += written;
+    }
+
+    bool ok = offset == m_writeSize;
+    m_writeSize = 0;
+    return ok;
+}
+
+void StreamSerializer::write(const char *pData, size_t size)
+{
+    size_t capacity = m_writeBuffer.size();
+
+    if (size >= capacity) {
+        // Large blocks are written directly bypassing the chunk buffer
+        flush();
+        size_t offset = 0;
+        while (m_pSink != 0 && offset < size) {
+            size_t written = m_pSink->writeBuffer(pData + offset, size - offset);
+            if (written == 0) {
+                m_error = true;
+                break;
+            }
+            offset += written;
+        }
+        return;
+    }
+
+    if (m_writeSize + size > capacity) {
+        flush();
+    }
+    memcpy(&m_writeBuffer[m_writeSize], pData, size);
+    m_writeSize += size;
+}
+
+bool StreamSerializer::fill(bool retry)
+{
+    if (m_pSource == 0) {
+        return false;
+    }
+
+    size_t bytes = 0;
+    while ((bytes = m_pSource->readBuffer(&m_readBuffer[0], m_readBuffer.size())) == 0) {
+        if (!m_pSource->isTimedOut()) {
+            // End of stream or source failure
+            m_error = true;
+            return false;
+        }
+        if (!retry) {
+            m_timedOut = true;
+            return false;
+        }
+    }
+
+    m_readIndex = 0;
+    m_readSize = bytes;
+    return true;
+}
+
+bool StreamSerializer::read(char *pBuffer, size_t size)
+{
+    while (size > 0) {
+        if (m_readIndex == m_readSize && !fill(true)) {
+            return false;
+        }
+        size_t bytes = m_readSize - m_readIndex;
+        if (bytes > size) {
+            bytes = size;
+        }
+        memcpy(pBuffer, &m_readBuffer[m_readIndex], bytes);
+        m_readIndex += bytes;
+        pBuffer += bytes;
+        size -= bytes;
+    }
+    return true;
+}
+
+template <typename T>
+void StreamSerializer::pushRawValue(T value)
+{
+    char buffer[sizeof(T)];
+    storeLittleEndian<T>(buffer, value);
+    write(buffer, sizeof(T));
+}
+
+template <typename T>
+bool StreamSerializer::popRawValue(T &value)
+{
+    char buffer[sizeof(T)];
+    if (!read(buffer, sizeof(T))) {
+        return false;
+    }
+    value = loadLittleEndian<T>(buffer);
+    return true;
+}
+
+void StreamSerializer::pushTypeSignature(Variant::Type type)
+{
+    char c = typeSignature(type);
+    write(&c, 1);
+}
+
+bool StreamSerializer::popTypeSignature(Variant::Type &type)
+{
+    char c = 0;
+    if (!read(&c, 1)) {
+        return false;
+    }
+    return signatureType(c, type);
+}
+
+void StreamSerializer::pushString(const std::string &value)
+{
+    unsigned length = value.length();
+    pushRawValue<unsigned>(length);
+    write(value.c_str(), length);
+}
+
+void StreamSerializer::pushList(const VariantList &value)
+{
+    unsigned size = value.size();
+    pushRawValue<unsigned>(size);
+    for (VariantList::const_iterator it = value.begin(); it != value.end(); ++it) {
+        encode(*it);
+    }
+}
+
+void StreamSerializer::pushMap(const VariantMap &value)
+{
+    unsigned size = value.size();
+    pushRawValue<unsigned>(size);
+    for (VariantMap::const_iterator it = value.begin(); it != value.end(); ++it) {
+        pushTypeSignature(Variant::Type_String);
+        pushString(it->first);
+        encode(it->second);
+    }
+}
+
+bool StreamSerializer::popString(std::string &value)
+{
+    unsigned length = 0;
+    if (!popRawValue<unsigned>(length)) {
+        return false;
+    }
+
+    // The string grows while its characters arrive, so a corrupted
+    // length cannot force a huge allocation up front.
+    value.clear();
+    while (length > 0) {
+        if (m_readIndex == m_readSize && !fill(true)) {
+            return false;
+        }
+        size_t bytes = m_readSize - m_readIndex;
+        if (bytes > length) {
+            bytes = length;
+        }
+        value.append(&m_readBuffer[m_readIndex], bytes);
+        m_readIndex += bytes;
+        length -= bytes;
+    }
+    return true;
+}
+
+bool StreamSerializer::popList(VariantList &value)
+{
+    unsigned length = 0;
+    if (!popRawValue<unsigned>(length)) {
+        return false;
+    }
+
+    value.clear();
+    for (unsigned i = 0; i < length; i++) {
+        value.push_back(Variant());
+        if (!decode(value.back())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool StreamSerializer::popMap(VariantMap &value)
+{
+    unsigned length = 0;
+    if (!popRawValue<unsigned>(length)) {
+        return false;
+    }
+
+    value.clear();
+    std::string key;
+    for (unsigned i = 0; i < length; i++) {
+        if (!popKey(key)) {
+            return false;
+        }
+        if (!decode(value[key])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool StreamSerializer::popKey(std::string &key)
+{
+    char c = 0;
+    if (!read(&c, 1)) {
+        return false;
+    }
+
+    if (c == cKeyReferenceSignature || c == cKeyDefinitionSignature) {
+        uint16_t id = 0;
+        if (!popRawValue<uint16_t>(id)) {
+            return false;
+        }
+        if (c == cKeyReferenceSignature) {
+            if (id >= m_keys.size()) {
+                // Undefined key
+                return false;
+            }
+            key = m_keys[id];
+            return true;
+        }
+        if (!popString(key)) {
+            return false;
+        }
+        if (id >= m_keys.size()) {
+            m_keys.resize(id + 1);
+        }
+        m_keys[id] = key;
+        return true;
+    }
+
+    Variant::Type type = Variant::Type_Invalid;
+    if (!signatureType(c, type) || type != Variant::Type_String) {
+        return false;
+    }
+    return popString(key);
+}
+
+} // namespace ucxx
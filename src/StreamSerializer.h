@@ -0,0 +1,134 @@
+#ifndef UCXX_STREAMSERIALIZER_H
+#define UCXX_STREAMSERIALIZER_H
+
+//
+// Variant serializer over a byte stream
+//
+
+#include <vector>
+#include "IVariantSerializer.h"
+#include "ByteStream.h"
+
+namespace ucxx {
+
+class Socket;
+
+/**
+ * @brief Implementation of IVariantSerializer interface over a byte stream.
+ * Values are encoded in the same format as ByteArraySerializer does, but
+ * instead of accumulating the whole message in memory the encoded bytes are
+ * collected in a fixed-size chunk buffer which is flushed into the sink each
+ * time it fills up. Decoding pulls the data from the source chunk by chunk
+ * while the value is being constructed.
+ * Peak memory used by the serializer itself is bounded by the chunk size
+ * regardless of the size of the values transferred.
+ * Map keys encoded via the key dictionary of ByteArraySerializer are
+ * understood when decoding.
+ */
+class StreamSerializer : public IVariantSerializer
+{
+public:
+
+    /// Default size of the encoding and decoding chunk buffers.
+    static const size_t DefaultChunkSize = 64 * 1024;
+
+    /**
+     * @brief Construct a serializer bound to a sink and/or a source.
+     * @param pSink Destination of the encoded values (may be null for decoding only).
+     * @param pSource Origin of the encoded values (may be null for encoding only).
+     * @param chunkSize Size of the internal chunk buffers.
+     */
+    StreamSerializer(IByteSink *pSink, IByteSource *pSource = 0, size_t chunkSize = DefaultChunkSize);
+
+    /**
+     * @brief Construct a serializer bound to a socket for both directions.
+     * @param pSocket Socket to write to and read from.
+     * @param chunkSize Size of the internal chunk buffers.
+     */
+    StreamSerializer(Socket *pSocket, size_t chunkSize = DefaultChunkSize);
+
+    /**
+     * @brief Destructor.
+     * Any pending encoded data is flushed into the sink.
+     */
+    ~StreamSerializer();
+
+    /**
+     * @brief Encode a value into the sink.
+     * The value is flushed completely before this method returns.
+     * @param value Value to be encoded.
+     */
+    void pushValue(const Variant &value);
+
+    /**
+     * @brief Decode next value from the source.
+     * This method will block in the source until enough data is received.
+     * If the source times out before the value starts (see
+     * IByteSource::isTimedOut()), nothing is consumed and isTimedOut()
+     * tells so; the call can simply be repeated. Timeouts in the middle of
+     * the value are waited out, so a value may arrive at any pace.
+     * @param value Decoded value.
+     * @return false on timeout, end of stream, source or format error.
+     */
+    bool popValue(Variant &value);
+
+    /**
+     * @brief Write pending encoded data into the sink.
+     * @return false if the sink failed to accept the data.
+     */
+    bool flush();
+
+    /**
+     * @brief Tells whether a sink or source failure has been detected.
+     */
+    bool isError() const { return m_error; }
+
+    /**
+     * @brief Tells whether the last popValue() found no data in time.
+     */
+    bool isTimedOut() const { return m_timedOut; }
+
+    size_t chunkSize() const { return m_writeBuffer.size(); }
+
+private:
+
+    // Disable copying
+    StreamSerializer(const StreamSerializer&) {}
+    StreamSerializer& operator =(const StreamSerializer&) { return *this; }
+
+    void encode(const Variant &value);
+    bool decode(Variant &value);
+    void write(const char *pData, size_t size);
+    bool read(char *pBuffer, size_t size);
+    bool fill(bool retry);
+
+    template <typename T> void pushRawValue(T value);
+    template <typename T> bool popRawValue(T &value);
+
+    void pushTypeSignature(Variant::Type type);
+    bool popTypeSignature(Variant::Type &type);
+
+    void pushString(const std::string &value);
+    void pushList(const VariantList &value);
+    void pushMap(const VariantMap &value);
+
+    bool popString(std::string &value);
+    bool popList(VariantList &value);
+    bool popMap(VariantMap &value);
+    bool popKey(std::string &key);
+
+    IByteSink *m_pSink;             ///< Encoded data destination.
+    IByteSource *m_pSource;         ///< Encoded data origin.
+    std::vector<char> m_writeBuffer;///< Encoding chunk.
+    size_t m_writeSize;             ///< Number of pending bytes in the encoding chunk.
+    std::vector<char> m_readBuffer; ///< Decoding chunk.
+    size_t m_readIndex;             ///< Read position within the decoding chunk.
+    size_t m_readSize;              ///< Number of valid bytes in the decoding chunk.
+    bool m_error;                   ///< Stream failure flag.
+    bool m_timedOut;                ///< Last popValue() timed out before the value.
+    std::vector<std::string> m_keys;///< Key dictionary of the decoded stream.
+};
+
+} // namespace ucxx
+
+#endif // UCXX_STREAMSERIALIZER_H
@@ -0,0 +1,287 @@
+#ifndef UCXX_STRUCTSERIALIZER_H
+#define UCXX_STRUCTSERIALIZER_H
+
+//
+// Compile-time serialization of plain structures
+//
+
+#include <string>
+#include <vector>
+#include <list>
+#include "ByteArraySerializer.h"
+
+namespace ucxx {
+
+/**
+ * @brief Serialization traits.
+ * Specializations of this template encode values of type T directly into
+ * ByteArraySerializer wire format, without building an intermediate Variant:
+ *
+ *     static void push(ByteArraySerializer &s, const T &value);
+ *     static bool pop(ByteArraySerializer &s, T &value);
+ *
+ * Specializations are provided for bool, int, double, float, std::string,
+ * Variant, std::vector (std::vector<bool> included) and std::list. Plain
+ * structures get one via the UCXX_SERIALIZABLE macro and are encoded as
+ * maps of their fields.
+ */
+template <typename T>
+struct Serializer;
+
+/**
+ * @brief Encode a value.
+ * @param s Serializer to write into.
+ * @param value Value to be encoded.
+ */
+template <typename T>
+void serialize(ByteArraySerializer &s, const T &value)
+{
+    Serializer<T>::push(s, value);
+}
+
+/**
+ * @brief Decode a value.
+ * Nothing is consumed if decoding fails.
+ * @param s Serializer to read from.
+ * @param value Decoded value.
+ * @return false if the data does not match the expected type.
+ */
+template <typename T>
+bool deserialize(ByteArraySerializer &s, T &value)
+{
+    unsigned index = s.position();
+    if (!Serializer<T>::pop(s, value)) {
+        s.seek(index);
+        return false;
+    }
+    return true;
+}
+
+template <>
+struct Serializer<bool>
+{
+    static void push(ByteArraySerializer &s, bool value) { s.pushBoolean(value); }
+    static bool pop(ByteArraySerializer &s, bool &value) { return s.popBoolean(value); }
+};
+
+template <>
+struct Serializer<int>
+{
+    static void push(ByteArraySerializer &s, int value) { s.pushInteger(value); }
+    static bool pop(ByteArraySerializer &s, int &value) { return s.popInteger(value); }
+};
+
+template <>
+struct Serializer<double>
+{
+    static void push(ByteArraySerializer &s, double value) { s.pushReal(value); }
+    static bool pop(ByteArraySerializer &s, double &value) { return s.popReal(value); }
+};
+
+template <>
+struct Serializer<float>
+{
+    static void push(ByteArraySerializer &s, float value) { s.pushReal(value); }
+    static bool pop(ByteArraySerializer &s, float &value)
+    {
+        double v;
+        if (!s.popReal(v)) {
+            return false;
+        }
+        value = static_cast<float>(v);
+        return true;
+    }
+};
+
+template <>
+struct Serializer<std::string>
+{
+    static void push(ByteArraySerializer &s, const std::string &value) { s.pushString(value); }
+    static bool pop(ByteArraySerializer &s, std::string &value) { return s.popString(value); }
+};
+
+template <>
+struct Serializer<Variant>
+{
+    static void push(ByteArraySerializer &s, const Variant &value) { s.pushValue(value); }
+    static bool pop(ByteArraySerializer &s, Variant &value) { return s.popValue(value); }
+};
+
+template <typename T>
+struct Serializer< std::vector<T> >
+{
+    static void push(ByteArraySerializer &s, const std::vector<T> &value)
+    {
+        s.pushListHeader(value.size());
+        for (typename std::vector<T>::const_iterator it = value.begin(); it != value.end(); ++it) {
+            Serializer<T>::push(s, *it);
+        }
+    }
+
+    static bool pop(ByteArraySerializer &s, std::vector<T> &value)
+    {
+        unsigned size = 0;
+        // Every element takes at least a byte, a larger count is corrupt
+        // and must not drive the allocation
+        if (!s.popListHeader(size) || size > s.available()) {
+            return false;
+        }
+        value.resize(size);
+        for (unsigned i = 0; i < size; i++) {
+            if (!Serializer<T>::pop(s, value[i])) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+// Elements of std::vector<bool> are bit proxies, decoded one by one
+template <>
+struct Serializer< std::vector<bool> >
+{
+    static void push(ByteArraySerializer &s, const std::vector<bool> &value)
+    {
+        s.pushListHeader(value.size());
+        for (std::vector<bool>::const_iterator it = value.begin(); it != value.end(); ++it) {
+            s.pushBoolean(*it);
+        }
+    }
+
+    static bool pop(ByteArraySerializer &s, std::vector<bool> &value)
+    {
+        unsigned size = 0;
+        if (!s.popListHeader(size) || size > s.available()) {
+            return false;
+        }
+        value.resize(size);
+        for (unsigned i = 0; i < size; i++) {
+            bool element = false;
+            if (!s.popBoolean(element)) {
+                return false;
+            }
+            value[i] = element;
+        }
+        return true;
+    }
+};
+
+template <typename T>
+struct Serializer< std::list<T> >
+{
+    static void push(ByteArraySerializer &s, const std::list<T> &value)
+    {
+        s.pushListHeader(value.size());
+        for (typename std::list<T>::const_iterator it = value.begin(); it != value.end(); ++it) {
+            Serializer<T>::push(s, *it);
+        }
+    }
+
+    static bool pop(ByteArraySerializer &s, std::list<T> &value)
+    {
+        unsigned size = 0;
+        // Every element takes at least a byte, a larger count is corrupt
+        // and must not drive the allocation
+        if (!s.popListHeader(size) || size > s.available()) {
+            return false;
+        }
+        value.resize(size);
+        for (typename std::list<T>::iterator it = value.begin(); it != value.end(); ++it) {
+            if (!Serializer<T>::pop(s, *it)) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+} // namespace ucxx
+
+/*
+ * Preprocessor helpers to apply a macro to each of up to 16 arguments.
+ */
+#define UCXX_PP_EXPAND(x) x
+#define UCXX_PP_CAT_(a, b) a##b
+#define UCXX_PP_CAT(a, b) UCXX_PP_CAT_(a, b)
+#define UCXX_PP_NARGS_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, N, ...) N
+#define UCXX_PP_NARGS(...) \
+    UCXX_PP_EXPAND(UCXX_PP_NARGS_(__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1))
+
+#define UCXX_PP_FOR_EACH_1(m, x) m(x)
+#define UCXX_PP_FOR_EACH_2(m, x, ...) m(x) UCXX_PP_EXPAND(UCXX_PP_FOR_EACH_1(m, __VA_ARGS__))
+#define UCXX_PP_FOR_EACH_3(m, x, ...) m(x) UCXX_PP_EXPAND(UCXX_PP_FOR_EACH_2(m, __VA_ARGS__))
+#define UCXX_PP_FOR_EACH_4(m, x, ...) m(x) UCXX_PP_EXPAND(UCXX_PP_FOR_EACH_3(m, __VA_ARGS__))
+#define UCXX_PP_FOR_EACH_5(m, x, ...) m(x) UCXX_PP_EXPAND(UCXX_PP_FOR_EACH_4(m, __VA_ARGS__))
+#define UCXX_PP_FOR_EACH_6(m, x, ...) m(x) UCXX_PP_EXPAND(UCXX_PP_FOR_EACH_5(m, __VA_ARGS__))
+#define UCXX_PP_FOR_EACH_7(m, x, ...) m(x) UCXX_PP_EXPAND(UCXX_PP_FOR_EACH_6(m, __VA_ARGS__))
+#define UCXX_PP_FOR_EACH_8(m, x, ...) m(x) UCXX_PP_EXPAND(UCXX_PP_FOR_EACH_7(m, __VA_ARGS__))
+#define UCXX_PP_FOR_EACH_9(m, x, ...) m(x) UCXX_PP_EXPAND(UCXX_PP_FOR_EACH_8(m, __VA_ARGS__))
+#define UCXX_PP_FOR_EACH_10(m, x, ...) m(x) UCXX_PP_EXPAND(UCXX_PP_FOR_EACH_9(m, __VA_ARGS__))
+#define UCXX_PP_FOR_EACH_11(m, x, ...) m(x) UCXX_PP_EXPAND(UCXX_PP_FOR_EACH_10(m, __VA_ARGS__))
+#define UCXX_PP_FOR_EACH_12(m, x, ...) m(x) UCXX_PP_EXPAND(UCXX_PP_FOR_EACH_11(m, __VA_ARGS__))
+#define UCXX_PP_FOR_EACH_13(m, x, ...) m(x) UCXX_PP_EXPAND(UCXX_PP_FOR_EACH_12(m, __VA_ARGS__))
+#define UCXX_PP_FOR_EACH_14(m, x, ...) m(x) UCXX_PP_EXPAND(UCXX_PP_FOR_EACH_13(m, __VA_ARGS__))
+#define UCXX_PP_FOR_EACH_15(m, x, ...) m(x) UCXX_PP_EXPAND(UCXX_PP_FOR_EACH_14(m, __VA_ARGS__))
+#define UCXX_PP_FOR_EACH_16(m, x, ...) m(x) UCXX_PP_EXPAND(UCXX_PP_FOR_EACH_15(m, __VA_ARGS__))
+#define UCXX_PP_FOR_EACH(m, ...) \
+    UCXX_PP_EXPAND(UCXX_PP_CAT(UCXX_PP_FOR_EACH_, UCXX_PP_NARGS(__VA_ARGS__))(m, __VA_ARGS__))
+
+#define UCXX_SERIALIZABLE_PUSH_FIELD(field) \
+    s.pushKey(#field, sizeof(#field) - 1); \
+    ::ucxx::Serializer<UCXX_SERIALIZABLE_FIELD_TYPE(field)>::push(s, value.field);
+
+#define UCXX_SERIALIZABLE_POP_FIELD(field) \
+    if (key == #field) { \
+        if (!::ucxx::Serializer<UCXX_SERIALIZABLE_FIELD_TYPE(field)>::pop(s, value.field)) { \
+            return false; \
+        } \
+        continue; \
+    }
+
+#define UCXX_SERIALIZABLE_FIELD_TYPE(field) decltype(value.field)
+
+/**
+ * @brief Make a plain structure serializable.
+ * Must be used at global namespace scope with a fully qualified structure name:
+ *
+ *     struct Quote { std::string symbol; double bid; double ask; };
+ *     UCXX_SERIALIZABLE(Quote, symbol, bid, ask)
+ *
+ * The structure is encoded as a map of its fields (in declaration order),
+ * so the result can be decoded by popValue() into a VariantMap. Decoding
+ * into the structure ignores unknown fields and leaves missing ones intact.
+ * Up to 16 fields are supported.
+ */
+#define UCXX_SERIALIZABLE(Struct, ...) \
+    namespace ucxx { \
+    template <> \
+    struct Serializer<Struct> \
+    { \
+        static void push(ByteArraySerializer &s, const Struct &value) \
+        { \
+            s.pushMapHeader(UCXX_PP_NARGS(__VA_ARGS__)); \
+            UCXX_PP_FOR_EACH(UCXX_SERIALIZABLE_PUSH_FIELD, __VA_ARGS__) \
+        } \
+        static bool pop(ByteArraySerializer &s, Struct &value) \
+        { \
+            unsigned size = 0; \
+            if (!s.popMapHeader(size)) { \
+                return false; \
+            } \
+            std::string key; \
+            for (unsigned i = 0; i < size; i++) { \
+                if (!s.popKey(key)) { \
+                    return false; \
+                } \
+                UCXX_PP_FOR_EACH(UCXX_SERIALIZABLE_POP_FIELD, __VA_ARGS__) \
+                Variant unknown; \
+                if (!s.popValue(unknown)) { \
+                    return false; \
+                } \
+            } \
+            return true; \
+        } \
+    }; \
+    }
+
+#endif // UCXX_STRUCTSERIALIZER_H
@@ -1,4 +1,5 @@
 #ifndef WIN32
+#   include <fcntl.h>
 #   include <unistd.h>
 #   include <netdb.h>
 #   include <netinet/in.h>
@@ -12,11 +13,14 @@
 
 #include <stdlib.h>
 #include <assert.h>
+#include "Fiber.h"
 #include "TcpServer.h"
 
 namespace ucxx {
 
 TcpServer::TcpServer()
+    : m_mutex("TcpServer"),
+      m_socket(-1)
 {
     // Be sure the sockets library is initialized.
     Socket::initialize();
@@ -37,6 +41,7 @@ bool TcpServer::listen(unsigned short port)
 
 bool TcpServer::listen(const std::string &hostName, unsigned short port)
 {
+    MutexLocker locker(&m_mutex);
     if (isListening()) {
         // Already listening
         return false;
@@ -72,8 +77,14 @@ bool TcpServer::listen(const std::string &hostName, unsigned short port)
         return false;
     }
 
-    MutexLocker locker(&m_mutex);
+#ifndef WIN32
+    // A connection may be gone (or taken by another thread) once the
+    // socket is reported readable, accept() must not block then.
+    fcntl(sock, F_SETFL, fcntl(sock, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
     m_pServerSocket = new TcpSocket(sock);
+    m_socket.store(sock);
     return true;
 }
 
@@ -85,22 +96,32 @@ TcpSocket* TcpServer::accept()
         return pSocket;
     }
 
-    struct timeval timeout;
-    timeout.tv_sec = 1;
-    timeout.tv_usec = 0;
-    fd_set fdset;
-
     SOCKET_TYPE sock = nativeSocket();
     if (sock < 0) {
         return 0;
     }
 
-    FD_ZERO(&fdset);
-    FD_SET(sock, &fdset);
-
-    int n = select(sock + 1, &fdset, NULL, NULL, &timeout);
-    if (n <= 0) {
-        return 0;
+#ifndef WIN32
+    if (Fiber::isFiber()) {
+        // Let other fibers run while waiting
+        if (!Fiber::waitReadable(sock, 1000)) {
+            return 0;
+        }
+    } else
+#endif
+    {
+        struct timeval timeout;
+        timeout.tv_sec = 1;
+        timeout.tv_usec = 0;
+        fd_set fdset;
+
+        FD_ZERO(&fdset);
+        FD_SET(sock, &fdset);
+
+        int n = select(sock + 1, &fdset, NULL, NULL, &timeout);
+        if (n <= 0) {
+            return 0;
+        }
     }
 
     struct sockaddr_in client;
@@ -113,6 +134,11 @@ TcpSocket* TcpServer::accept()
         return pSocket;
     }
 
+#if !defined(WIN32) && !defined(__linux__)
+    // Accepted sockets inherit the non-blocking mode on BSD systems
+    fcntl(clientSock, F_SETFL, fcntl(clientSock, F_GETFL, 0) & ~O_NONBLOCK);
+#endif
+
     char *clientIp = inet_ntoa(client.sin_addr);
     unsigned short clientPort = ntohs(client.sin_port);
 
@@ -127,6 +153,7 @@ void TcpServer::close()
 {
     MutexLocker locker(&m_mutex);
     if (m_pServerSocket != 0) {
+        m_socket.store(-1);
         m_pServerSocket->close();
         delete m_pServerSocket;
         m_pServerSocket = 0;
@@ -135,17 +162,13 @@ void TcpServer::close()
 
 bool TcpServer::isListening() const
 {
-    MutexLocker locker(&m_mutex);
-    return m_pServerSocket != 0;
+    return nativeSocket() >= 0;
 }
 
 SOCKET_TYPE TcpServer::nativeSocket() const
 {
-    MutexLocker locker(&m_mutex);
-    if (!m_pServerSocket) {
-        return -1;
-    }
-    return m_pServerSocket->nativeSocket();
+    // Read without locking, accept() calls this on every connection
+    return m_socket.load();
 }
 
 } // namespace ucxx
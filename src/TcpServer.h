@@ -5,6 +5,7 @@
 // Platform-specific TCP server socket
 //
 
+#include <atomic>
 #include "Mutex.h"
 #include "TcpSocket.h"
 
@@ -39,8 +40,9 @@ private:
 
     SOCKET_TYPE nativeSocket() const;
 
-    mutable Mutex m_mutex; ///< Protective mutex.
+    Mutex m_mutex; ///< Serializes listen() and close().
     TcpSocket *m_pServerSocket;
+    std::atomic<SOCKET_TYPE> m_socket; ///< Listening socket descriptor, -1 if not listening.
     int m_maxPendingConnections;
 };
 
@@ -1,4 +1,6 @@
 #ifndef WIN32
+#   include <errno.h>
+#   include <fcntl.h>
 #   include <unistd.h>
 #   include <netdb.h>
 #   include <netinet/in.h>
@@ -15,12 +17,98 @@
 #include <iostream>
 #include <assert.h>
 #include <string.h>
+#include "Fiber.h"
 #include "TcpSocket.h"
 
 namespace ucxx {
 
+/*
+ * Called from a fiber, socket operations must not block the thread: they
+ * are attempted without waiting and the fiber waits for the socket to be
+ * ready whenever they would block.
+ */
+
+static int receive(SOCKET_TYPE sock, char *pBuffer, size_t size, unsigned timeout)
+{
+#ifndef WIN32
+    if (Fiber::isFiber()) {
+        for (;;) {
+            int s = recv(sock, pBuffer, size, MSG_DONTWAIT);
+            if (s >= 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+                return s;
+            }
+            if (errno != EINTR && !Fiber::waitReadable(sock, timeout)) {
+                return -1;
+            }
+        }
+    }
+#endif
+    return recv(sock, pBuffer, size, 0);
+}
+
+// Tells whether a failed receive() ran into the read timeout
+static bool isTimeout()
+{
+#ifdef WIN32
+    return WSAGetLastError() == WSAETIMEDOUT;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == ETIMEDOUT;
+#endif
+}
+
+static int transmit(SOCKET_TYPE sock, const char *pData, size_t size)
+{
+#ifndef WIN32
+    if (Fiber::isFiber()) {
+        // Send everything, like a blocking socket
+        size_t sent = 0;
+        while (sent < size) {
+            int s = send(sock, pData + sent, size - sent, MSG_DONTWAIT);
+            if (s >= 0) {
+                sent += s;
+            } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (!Fiber::waitWritable(sock)) {
+                    return sent > 0 ? static_cast<int>(sent) : -1;
+                }
+            } else if (errno != EINTR) {
+                return sent > 0 ? static_cast<int>(sent) : -1;
+            }
+        }
+        return static_cast<int>(sent);
+    }
+#endif
+    return send(sock, pData, size, 0);
+}
+
+static int connectSocket(SOCKET_TYPE sock, const struct sockaddr *pAddress, int length)
+{
+#ifndef WIN32
+    if (Fiber::isFiber()) {
+        int flags = fcntl(sock, F_GETFL, 0);
+        fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+        int res = connect(sock, pAddress, length);
+        if (res < 0 && errno == EINPROGRESS) {
+            int error = 0;
+            socklen_t errorLength = sizeof(error);
+            if (!Fiber::waitWritable(sock) ||
+                getsockopt(sock, SOL_SOCKET, SO_ERROR, &error, &errorLength) != 0 ||
+                error != 0) {
+                res = -1;
+            } else {
+                res = 0;
+            }
+        }
+        fcntl(sock, F_SETFL, flags);
+        return res;
+    }
+#endif
+    return connect(sock, pAddress, length);
+}
+
 TcpSocket::TcpSocket()
-    : Socket(Socket::Protocol_Tcp)
+    : Socket(Socket::Protocol_Tcp),
+      m_readTimeout(0),
+      m_timedOut(false)
 {
 #ifdef WIN32
     m_socket = INVALID_SOCKET;
@@ -30,7 +118,9 @@ TcpSocket::TcpSocket()
 }
 
 TcpSocket::TcpSocket(SOCKET_TYPE s)
-    : Socket(Socket::Protocol_Tcp)
+    : Socket(Socket::Protocol_Tcp),
+      m_readTimeout(1000),
+      m_timedOut(false)
 {
     m_socket = s;
 
@@ -56,18 +146,24 @@ TcpSocket::~TcpSocket()
 
 SOCKET_TYPE TcpSocket::nativeSocket() const
 {
-    MutexLocker locker(&m_mutex);
+    ReadLocker locker(&m_lock);
     return m_socket;
 }
 
 size_t TcpSocket::readBuffer(char *pBuffer, size_t size)
 {
+    m_timedOut = false;
     if (!isConnected()) {
         return 0;
     }
 
     SOCKET_TYPE sock = nativeSocket();
-    int s = recv(sock, pBuffer, size, 0);
+    int s = receive(sock, pBuffer, size, m_readTimeout);
+    if (s < 0 && isTimeout()) {
+        // Nothing received in time, the connection is still fine
+        m_timedOut = true;
+        return 0;
+    }
     if (s < 0) {
         // Socket error
         setError("Unable to read data");
@@ -83,7 +179,7 @@ size_t TcpSocket::writeBuffer(const char *pData, size_t size)
     }
 
     SOCKET_TYPE sock = nativeSocket();
-    int s = send(sock, pData, size, 0);
+    int s = transmit(sock, pData, size);
     if (s < 0) {
         // Error sending data
         setError("Unable to send data");
@@ -132,7 +228,7 @@ void TcpSocket::close(Stream stream)
 
 bool TcpSocket::isConnected() const
 {
-    MutexLocker locker(&m_mutex);
+    ReadLocker locker(&m_lock);
     return m_socket > 0;
 }
 
@@ -152,8 +248,8 @@ bool TcpSocket::connectToHost(const std::string &hostName, unsigned short port)
     server.sin_addr.s_addr = inet_addr(hostName.c_str());
     server.sin_family = AF_INET;
     server.sin_port = htons(port);
-    if (connect(sock, (struct sockaddr*)&server, sizeof(server)) >= 0) {
-        MutexLocker locker(&m_mutex);
+    if (connectSocket(sock, (struct sockaddr*)&server, sizeof(server)) >= 0) {
+        WriteLocker locker(&m_lock);
         m_socket = sock;
         return true;
     }
@@ -163,13 +259,13 @@ bool TcpSocket::connectToHost(const std::string &hostName, unsigned short port)
 
 std::string TcpSocket::peerAddr() const
 {
-    MutexLocker locker(&m_mutex);
+    ReadLocker locker(&m_lock);
     return m_peerAddr;
 }
 
 unsigned short TcpSocket::peerPort() const
 {
-    MutexLocker locker(&m_mutex);
+    ReadLocker locker(&m_lock);
     return m_peerPort;
 }
 
@@ -184,7 +280,7 @@ std::string TcpSocket::readLine(size_t size)
     size_t length = 0;
     char c = '\0';
     do {
-        int read = recv(sock, &c, 1, 0);
+        int read = receive(sock, &c, 1, m_readTimeout);
         if (read < 0) {
             setError("Unable to read data");
             return line;
@@ -225,13 +321,13 @@ std::string TcpSocket::hostNameToIp(const std::string &hostName)
 
 void TcpSocket::setPeerAddr(const std::string &addr)
 {
-    MutexLocker locker(&m_mutex);
+    WriteLocker locker(&m_lock);
     m_peerAddr = addr;
 }
 
 void TcpSocket::setPeerPort(unsigned short port)
 {
-    MutexLocker locker(&m_mutex);
+    WriteLocker locker(&m_lock);
     m_peerPort = port;
 }
 
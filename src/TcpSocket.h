@@ -14,7 +14,7 @@
 #endif
 
 #include <string>
-#include "Mutex.h"
+#include "ReadWriteLock.h"
 #include "Socket.h"
 
 namespace ucxx {
@@ -32,6 +32,7 @@ public:
     ~TcpSocket();
 
     size_t readBuffer(char *pBuffer, size_t size);
+    bool isTimedOut() const { return m_timedOut; }
     size_t writeBuffer(const char *pData, size_t size);
     size_t available();
     void close(Stream stream = Stream_All);
@@ -59,7 +60,9 @@ private:
     SOCKET_TYPE m_socket;
     std::string m_peerAddr;
     unsigned short m_peerPort;
-    mutable Mutex m_mutex;  ///< Protective mutex.
+    unsigned m_readTimeout;         ///< Receive timeout of fibers in milliseconds, 0 if none.
+    bool m_timedOut;                ///< Last readBuffer() timed out, owned by the reader.
+    mutable ReadWriteLock m_lock;   ///< Protects the members, mostly read.
 };
 
 } // namespace ucxx
@@ -1,13 +1,18 @@
 #ifndef WIN32
-#   ifdef __APPLE__
-#       include <sys/time.h>
-#   endif
 #   include <time.h>
+#   include <errno.h>
+#   include <sched.h>
+#   include <unistd.h>
+#   include <sys/resource.h>
+#   ifdef __linux__
+#       include <dirent.h>
+#       include <stdlib.h>
+#       include <sys/syscall.h>
+#   endif
 #endif
 
 #include <assert.h>
 #include "Mutex.h"
-#include "Sema.h"
 #include "Thread.h"
 
 namespace ucxx {
@@ -19,6 +24,7 @@ DWORD WINAPI threadRunner(LPVOID lpParam)
 {
     assert(lpParam);
     Thread *pThread = static_cast<Thread*>(lpParam);
+    pThread->applySettings();
     pThread->setRunning(true);
     pThread->run();
     pThread->setRunning(false);
@@ -29,9 +35,7 @@ void* threadRunner(void *param)
 {
     assert(param);
     Thread *pThread = static_cast<Thread*> (param);
-
-    // Thread will block here waiting for starting semaphore
-    pThread->m_pStartSemaphore->wait();
+    pThread->applySettings();
     pThread->setRunning(true);
     pThread->run();
     pThread->setRunning(false);
@@ -39,59 +43,249 @@ void* threadRunner(void *param)
 }
 #endif
 
+namespace {
+
+#ifndef WIN32
+int nativePolicy(Thread::SchedulingPolicy policy)
+{
+    switch (policy) {
+    case Thread::Scheduling_Fifo:
+        return SCHED_FIFO;
+    case Thread::Scheduling_RoundRobin:
+        return SCHED_RR;
+    default:
+        return SCHED_OTHER;
+    }
+}
+#endif
+
+#ifdef __linux__
+void makeCpuSet(const std::vector<unsigned> &cpus, cpu_set_t *pSet)
+{
+    CPU_ZERO(pSet);
+    if (cpus.empty()) {
+        for (unsigned i = 0; i < CPU_SETSIZE; i++) {
+            CPU_SET(i, pSet);
+        }
+        return;
+    }
+    for (size_t i = 0; i < cpus.size(); i++) {
+        if (cpus[i] < CPU_SETSIZE) {
+            CPU_SET(cpus[i], pSet);
+        }
+    }
+}
+#endif
+
+#ifndef WIN32
+int niceValue(Thread::Priority priority)
+{
+    switch (priority) {
+    case Thread::Priority_Idle:
+        return 19;
+    case Thread::Priority_Lowest:
+        return 10;
+    case Thread::Priority_Low:
+        return 5;
+    case Thread::Priority_High:
+        return -5;
+    case Thread::Priority_Highest:
+        return -10;
+    case Thread::Priority_Realtime:
+        return -20;
+    default:
+        return 0;
+    }
+}
+#endif
+
+} // namespace
+
 /* Thread class implementation */
 
 Thread::Thread(IRunnable *pRunnable)
 {
+    m_started = false;
+    m_stackSize = 0;
+    m_scheduling = false;
+    m_policy = Scheduling_Other;
+    m_schedulingPriority = 0;
+    m_niceSet = false;
+    m_nice = 0;
     m_running = false;
+    m_settingsFailed = false;
     m_pMutex = new Mutex();
     m_pRunnable = pRunnable;
 
+#ifdef WIN32
+    m_thread = 0;
+    m_threadId = 0;
+#endif
+}
+
+Thread::~Thread()
+{
+#ifdef WIN32
+    if (m_thread) {
+        CloseHandle(m_thread);
+    }
+#endif
+    delete m_pMutex;
+}
+
+void Thread::setRunning(bool value)
+{
+    MutexLocker locker(m_pMutex);
+    m_running = value;
+}
+
+bool Thread::start()
+{
+    if (m_started) {
+        return false;
+    }
+
 #ifdef WIN32
     m_thread = CreateThread(
             0, // Default security attributes
-            0, // Default stack size
+            m_stackSize, // Stack size, 0 for default
             (LPTHREAD_START_ROUTINE)threadRunner, // Thread routine
             this, // Argument to thread routine
-            CREATE_SUSPENDED, // Do not start the thread
+            CREATE_SUSPENDED, // Apply settings before it runs
             &m_threadId // Returned thread id
     );
-    assert(m_thread);
+    if (!m_thread) {
+        return false;
+    }
+    if (!m_affinity.empty()) {
+        DWORD_PTR mask = 0;
+        for (size_t i = 0; i < m_affinity.size(); i++) {
+            if (m_affinity[i] < sizeof(DWORD_PTR) * 8) {
+                mask |= static_cast<DWORD_PTR>(1) << m_affinity[i];
+            }
+        }
+        SetThreadAffinityMask(m_thread, mask);
+    }
+    m_started = true;
+    ResumeThread(m_thread);
+    return true;
 #else
-    m_pStartSemaphore = new Semaphore();
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    // A rejected attribute would silently fall back to the default
+    bool ok = true;
+    if (m_stackSize > 0) {
+        // Some systems only accept whole pages
+        size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t stackSize = (m_stackSize + pageSize - 1) / pageSize * pageSize;
+        ok = pthread_attr_setstacksize(&attr, stackSize) == 0;
+    }
+    if (ok && m_scheduling) {
+        struct sched_param param;
+        param.sched_priority = m_schedulingPriority;
+        ok = pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED) == 0 &&
+             pthread_attr_setschedpolicy(&attr, nativePolicy(m_policy)) == 0 &&
+             pthread_attr_setschedparam(&attr, &param) == 0;
+    }
+    if (!ok) {
+        pthread_attr_destroy(&attr);
+        return false;
+    }
+#ifdef __linux__
+    if (!m_affinity.empty()) {
+        cpu_set_t cpuSet;
+        makeCpuSet(m_affinity, &cpuSet);
+        pthread_attr_setaffinity_np(&attr, sizeof(cpuSet), &cpuSet);
+    }
+#endif
 
     int res = pthread_create(&m_thread, // Thread reference
-            0, // Attributes
+            &attr, // Attributes
             &threadRunner, // Thread routine
             this // Argument to the thread routine
             );
-    assert(!res);
+    pthread_attr_destroy(&attr);
+    if (res != 0) {
+        return false;
+    }
+    m_started = true;
+    return true;
 #endif
 }
 
-Thread::~Thread()
+void Thread::applySettings()
 {
-#ifdef WIN32
-    CloseHandle(m_thread);
-#else
-    delete m_pStartSemaphore;
+    // Names are informational only, not reported
+    bool ok = true;
+    if (!m_name.empty()) {
+        setCurrentThreadName(m_name);
+    }
+    if (m_niceSet) {
+        ok = setCurrentThreadNice(m_nice) && ok;
+    }
+#if !defined WIN32 && !defined __linux__
+    // No affinity attribute, the best we can do is to try from the thread
+    if (!m_affinity.empty()) {
+        ok = setCurrentThreadAffinity(m_affinity) && ok;
+    }
 #endif
-    delete m_pMutex;
+
+    MutexLocker locker(m_pMutex);
+    m_settingsFailed = !ok;
 }
 
-void Thread::setRunning(bool value)
+bool Thread::settingsFailed() const
 {
     MutexLocker locker(m_pMutex);
-    m_running = value;
+    return m_settingsFailed;
 }
 
-void Thread::start()
+bool Thread::setStackSize(size_t bytes)
 {
-#ifdef WIN32
-    ResumeThread(m_thread);
-#else
-    m_pStartSemaphore->notify();
-#endif
+    if (m_started) {
+        return false;
+    }
+    m_stackSize = bytes;
+    return true;
+}
+
+bool Thread::setName(const std::string &name)
+{
+    if (m_started) {
+        return false;
+    }
+    m_name = name;
+    return true;
+}
+
+bool Thread::setAffinity(const std::vector<unsigned> &cpus)
+{
+    if (m_started) {
+        return false;
+    }
+    m_affinity = cpus;
+    return true;
+}
+
+bool Thread::setSchedulingPolicy(SchedulingPolicy policy, int priority)
+{
+    if (m_started) {
+        return false;
+    }
+    m_scheduling = true;
+    m_policy = policy;
+    m_schedulingPriority = priority;
+    return true;
+}
+
+bool Thread::setNice(int nice)
+{
+    if (m_started) {
+        return false;
+    }
+    m_niceSet = true;
+    m_nice = nice;
+    return true;
 }
 
 void Thread::run()
@@ -110,6 +304,9 @@ bool Thread::isRunning() const
 
 void Thread::terminate()
 {
+    if (!m_started) {
+        return;
+    }
 #ifdef WIN32
     TerminateThread(m_thread, 0);
 #else
@@ -119,6 +316,9 @@ void Thread::terminate()
 
 void Thread::join()
 {
+    if (!m_started) {
+        return;
+    }
 #ifdef WIN32
     WaitForSingleObject(m_thread, INFINITE);
 #else
@@ -132,32 +332,13 @@ void Thread::sleep(unsigned int milliseconds)
     Sleep(milliseconds);
 #else
     struct timespec ts;
-    pthread_mutex_t sleepMutex;
-    pthread_cond_t sleepCond;
-
-    pthread_mutex_init(&sleepMutex, 0);
-    pthread_cond_init(&sleepCond, 0);
-#ifdef __APPLE__
-    struct timeval tv;
-    // Darwin does not have clock_gettime function.
-    gettimeofday(&tv, 0);
-    ts.tv_sec = tv.tv_sec + milliseconds / 1000;
-    ts.tv_nsec = tv.tv_usec * 1000 + (milliseconds % 1000) * 1000000;
-#else
-    clock_gettime(CLOCK_REALTIME, &ts);
-    ts.tv_sec += milliseconds / 1000;
-    ts.tv_nsec += (milliseconds % 1000) * 1000000;
-#endif
-
-    ts.tv_sec += ts.tv_nsec / 1000000000;
-    ts.tv_nsec %= 1000000000;
+    ts.tv_sec = milliseconds / 1000;
+    ts.tv_nsec = (milliseconds % 1000) * 1000000;
 
-    pthread_mutex_lock(&sleepMutex);
-    pthread_cond_timedwait(&sleepCond, &sleepMutex, &ts);
-    pthread_mutex_unlock(&sleepMutex);
-
-    pthread_cond_destroy(&sleepCond);
-    pthread_mutex_destroy(&sleepMutex);
+    // Keep sleeping for the remaining time when interrupted by a signal
+    while (nanosleep(&ts, &ts) == -1 && errno == EINTR) {
+        continue;
+    }
 #endif
 }
 
@@ -195,6 +376,8 @@ void Thread::setCurrentThreadPriority(Thread::Priority priority)
     if (!res) {
         //DWORD err = GetLastError();
     }
+#else
+    setCurrentThreadNice(niceValue(priority));
 #endif
 }
 
@@ -230,6 +413,82 @@ void Thread::setCurrentProcessPriority(Thread::Priority priority)
     if (!res) {
         //DWORD err = GetLastError();
     }
+#elif defined __linux__
+    // Nice values are per thread on Linux, assign all threads of the process
+    DIR *pDir = opendir("/proc/self/task");
+    if (pDir == 0) {
+        return;
+    }
+    struct dirent *pEntry;
+    while ((pEntry = readdir(pDir)) != 0) {
+        int tid = atoi(pEntry->d_name);
+        if (tid > 0) {
+            setpriority(PRIO_PROCESS, tid, niceValue(priority));
+        }
+    }
+    closedir(pDir);
+#else
+    setpriority(PRIO_PROCESS, 0, niceValue(priority));
+#endif
+}
+
+bool Thread::setCurrentThreadName(const std::string &name)
+{
+#if defined __linux__
+    // The kernel limits names to 16 bytes including the terminator
+    return pthread_setname_np(pthread_self(), name.substr(0, 15).c_str()) == 0;
+#elif defined __APPLE__
+    return pthread_setname_np(name.c_str()) == 0;
+#else
+    (void)name;
+    return false;
+#endif
+}
+
+bool Thread::setCurrentThreadAffinity(const std::vector<unsigned> &cpus)
+{
+#ifdef WIN32
+    DWORD_PTR mask = 0;
+    for (size_t i = 0; i < cpus.size(); i++) {
+        if (cpus[i] < sizeof(DWORD_PTR) * 8) {
+            mask |= static_cast<DWORD_PTR>(1) << cpus[i];
+        }
+    }
+    if (cpus.empty()) {
+        DWORD_PTR systemMask;
+        GetProcessAffinityMask(GetCurrentProcess(), &mask, &systemMask);
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined __linux__
+    cpu_set_t cpuSet;
+    makeCpuSet(cpus, &cpuSet);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+bool Thread::setCurrentThreadSchedulingPolicy(SchedulingPolicy policy, int priority)
+{
+#ifdef WIN32
+    (void)policy;
+    (void)priority;
+    return false;
+#else
+    struct sched_param param;
+    param.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), nativePolicy(policy), &param) == 0;
+#endif
+}
+
+bool Thread::setCurrentThreadNice(int nice)
+{
+#ifdef __linux__
+    return setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), nice) == 0;
+#else
+    (void)nice;
+    return false;
 #endif
 }
 
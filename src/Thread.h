@@ -10,11 +10,13 @@
 #else
 #   include <pthread.h>
 #endif
+#include <stddef.h>
+#include <string>
+#include <vector>
 
 namespace ucxx {
 
 class Mutex;
-class Semaphore;
 
 /**
  * @brief Thread runnable interface.
@@ -46,6 +48,15 @@ public:
         Priority_Realtime
     };
 
+    /**
+     * Thread scheduling policies (POSIX).
+     */
+    enum SchedulingPolicy {
+        Scheduling_Other,       ///< Default time-sharing policy (SCHED_OTHER).
+        Scheduling_Fifo,        ///< Real-time first-in first-out policy (SCHED_FIFO).
+        Scheduling_RoundRobin   ///< Real-time round-robin policy (SCHED_RR).
+    };
+
     /**
      * @brief Construct a thread.
      * The thread is constructed in suspended state. Caller has to
@@ -60,8 +71,65 @@ public:
 
     /**
      * @brief Start thread execution.
+     * The system thread is created here, with the settings assigned
+     * by the setters below.
+     * @return false if the thread could not be created, e.g. for lack of
+     * privileges for a real-time scheduling policy, or if the stack size
+     * or scheduling settings are rejected by the system.
+     */
+    bool start();
+
+    /*
+     * Following settings have to be assigned before start(), they return
+     * false once the thread has been started. Use the setCurrentThread*
+     * counterparts from within a running thread.
+     */
+
+    /**
+     * @brief Set stack size of the thread.
+     * The size is rounded up to whole pages on POSIX systems; start()
+     * fails if it is below the system minimum (PTHREAD_STACK_MIN).
+     * @param bytes Stack size, 0 for the system default.
+     */
+    bool setStackSize(size_t bytes);
+
+    /**
+     * @brief Set thread name, shown by debuggers and tools like top or perf.
+     * The name is truncated to 15 characters on Linux.
+     */
+    bool setName(const std::string &name);
+
+    /**
+     * @brief Set processors the thread may run on.
+     * @param cpus Processor indexes, empty for any processor.
      */
-    void start();
+    bool setAffinity(const std::vector<unsigned> &cpus);
+
+    /**
+     * @brief Set scheduling policy of the thread.
+     * @param policy Scheduling policy, real-time policies usually
+     * require privileges.
+     * @param priority Static priority, 1 (lowest) to 99 for real-time
+     * policies, 0 for Scheduling_Other.
+     */
+    bool setSchedulingPolicy(SchedulingPolicy policy, int priority = 0);
+
+    /**
+     * @brief Set nice value of the thread (Linux).
+     * The value is applied by the thread itself once started, on a best
+     * effort basis: raising the priority (negative change) usually
+     * requires privileges, see settingsFailed().
+     * @param nice Nice value, -20 (highest priority) to 19 (lowest).
+     */
+    bool setNice(int nice);
+
+    /**
+     * @brief Tells whether a setting applied by the started thread itself
+     * (nice value, affinity where there is no thread attribute for it)
+     * has failed.
+     * Meaningful once the thread has started running.
+     */
+    bool settingsFailed() const;
 
     /**
      * Tells whether a thread is running.
@@ -106,6 +174,31 @@ public:
      */
     static void setCurrentProcessPriority(Thread::Priority priority);
 
+    /**
+     * Assign name of the current thread.
+     * @return false if not supported or failed.
+     */
+    static bool setCurrentThreadName(const std::string &name);
+
+    /**
+     * Assign processors the current thread may run on.
+     * @param cpus Processor indexes, empty for any processor.
+     * @return false if not supported or failed.
+     */
+    static bool setCurrentThreadAffinity(const std::vector<unsigned> &cpus);
+
+    /**
+     * Assign scheduling policy of the current thread.
+     * @return false if not supported or failed.
+     */
+    static bool setCurrentThreadSchedulingPolicy(SchedulingPolicy policy, int priority = 0);
+
+    /**
+     * Assign nice value of the current thread (Linux).
+     * @return false if not supported or failed.
+     */
+    static bool setCurrentThreadNice(int nice);
+
     /**
      * System thread routine.
      */
@@ -125,6 +218,11 @@ private:
      */
     void setRunning(bool value);
 
+    /**
+     * @brief Apply settings which can only be applied by the thread itself.
+     */
+    void applySettings();
+
     /**
      * System thread reference.
      */
@@ -133,10 +231,19 @@ private:
     DWORD m_threadId;   ///< System thread id.
 #else
     pthread_t m_thread; ///< System thread.
-    Semaphore *m_pStartSemaphore;    ///< Thread starting semaphore.
 #endif
 
+    bool m_started;     ///< System thread created.
+    size_t m_stackSize; ///< Stack size, 0 for default.
+    std::string m_name; ///< Thread name.
+    std::vector<unsigned> m_affinity;   ///< Allowed processors, empty for any.
+    bool m_scheduling;  ///< Scheduling policy assigned.
+    SchedulingPolicy m_policy;  ///< Scheduling policy.
+    int m_schedulingPriority;   ///< Static priority for the scheduling policy.
+    bool m_niceSet;     ///< Nice value assigned.
+    int m_nice;         ///< Nice value.
     bool m_running;     ///< Thread running flag.
+    bool m_settingsFailed;  ///< A setting applied by the thread failed.
     Mutex *m_pMutex;    ///< Protective mutex.
     IRunnable *m_pRunnable;  ///< Pointer to an object implementing IRunnable interface.
 };
@@ -0,0 +1,252 @@
+#ifdef WIN32
+#   include <Windows.h>
+#else
+#   include <unistd.h>
+#endif
+
+#include "WorkStealingDeque.h"
+#include "ThreadPool.h"
+
+namespace ucxx {
+
+/// Worker thread with its own task deque.
+struct ThreadPool::Worker : public IRunnable
+{
+    ThreadPool *pPool;                      ///< Owning pool.
+    WorkStealingDeque<IRunnable> deque;     ///< Local tasks.
+    Thread *pThread;                        ///< Worker thread.
+    uint32_t seed;                          ///< Victim selection state.
+    std::atomic<uint64_t> executed;         ///< Tasks executed.
+    std::atomic<uint64_t> stolen;           ///< Tasks stolen from other workers.
+
+    Worker(ThreadPool *pool, unsigned index)
+        : pPool(pool), pThread(0), seed(index * 2654435761u + 1), executed(0), stolen(0) {}
+
+    void run() { pPool->work(this); }
+};
+
+thread_local ThreadPool::Worker *ThreadPool::s_pCurrentWorker = 0;
+
+ThreadPool::ThreadPool(unsigned threadCount)
+    : m_threadCount(0),
+      m_mutex("ThreadPool"),
+      m_queueSize(0),
+      m_idle(0),
+      m_stopping(false),
+      m_executed(0),
+      m_stolen(0)
+{
+    if (threadCount == 0) {
+        threadCount = processorCount();
+    }
+
+    // All workers must exist before any of them starts stealing
+    for (unsigned i = 0; i < threadCount; i++) {
+        m_workers.push_back(new Worker(this, i));
+    }
+    // A worker whose thread cannot be created keeps an empty deque
+    unsigned started = 0;
+    for (unsigned i = 0; i < threadCount; i++) {
+        m_workers[i]->pThread = new Thread(m_workers[i]);
+        if (m_workers[i]->pThread->start()) {
+            started++;
+        }
+    }
+    m_threadCount = started;
+}
+
+ThreadPool::~ThreadPool()
+{
+    m_stopping.store(true);
+    m_semaphore.notify(static_cast<int>(m_workers.size()));
+
+    for (size_t i = 0; i < m_workers.size(); i++) {
+        m_workers[i]->pThread->join();
+    }
+    for (size_t i = 0; i < m_workers.size(); i++) {
+        delete m_workers[i]->pThread;
+        delete m_workers[i];
+    }
+}
+
+void ThreadPool::submit(IRunnable *pRunnable)
+{
+    if (m_threadCount == 0) {
+        // No worker would ever run it
+        pRunnable->run();
+        m_executed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Worker *pWorker = s_pCurrentWorker;
+    if (pWorker != 0 && pWorker->pPool == this) {
+        pWorker->deque.push(pRunnable);
+    } else {
+        MutexLocker locker(&m_mutex);
+        m_queue.push_back(pRunnable);
+        m_queueSize.store(m_queue.size(), std::memory_order_relaxed);
+    }
+
+    // Pairs with the idle counter increment in work(): either a worker going
+    // to sleep sees the new task, or we see the worker and wake it up.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_idle.load(std::memory_order_relaxed) > 0) {
+        m_semaphore.notify();
+    }
+}
+
+bool ThreadPool::runPendingTask()
+{
+    Worker *pWorker = s_pCurrentWorker;
+    if (pWorker != 0 && pWorker->pPool != this) {
+        pWorker = 0;
+    }
+
+    IRunnable *pTask = findTask(pWorker);
+    if (pTask == 0) {
+        return false;
+    }
+
+    pTask->run();
+    if (pWorker != 0) {
+        pWorker->executed.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        m_executed.fetch_add(1, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+void ThreadPool::work(Worker *pWorker)
+{
+    s_pCurrentWorker = pWorker;
+
+    for (;;) {
+        IRunnable *pTask = findTask(pWorker);
+        if (pTask == 0) {
+            // Announce going to sleep and look once more, see submit()
+            m_idle.fetch_add(1);
+            pTask = findTask(pWorker);
+            if (pTask == 0) {
+                if (m_stopping.load()) {
+                    m_idle.fetch_sub(1);
+                    break;
+                }
+                m_semaphore.wait();
+                m_idle.fetch_sub(1);
+                continue;
+            }
+            m_idle.fetch_sub(1);
+        }
+
+        pTask->run();
+        pWorker->executed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    s_pCurrentWorker = 0;
+}
+
+IRunnable* ThreadPool::findTask(Worker *pWorker)
+{
+    IRunnable *pTask = 0;
+    if (pWorker != 0) {
+        pTask = pWorker->deque.take();
+        if (pTask != 0) {
+            return pTask;
+        }
+    }
+
+    if (m_queueSize.load(std::memory_order_relaxed) > 0) {
+        MutexLocker locker(&m_mutex);
+        if (!m_queue.empty()) {
+            pTask = m_queue.front();
+            m_queue.pop_front();
+            m_queueSize.store(m_queue.size(), std::memory_order_relaxed);
+            return pTask;
+        }
+    }
+
+    return steal(pWorker);
+}
+
+IRunnable* ThreadPool::steal(Worker *pWorker)
+{
+    // Start with a random victim, so thieves do not gang up on one worker
+    size_t count = m_workers.size();
+    size_t first = 0;
+    if (pWorker != 0) {
+        pWorker->seed ^= pWorker->seed << 13;
+        pWorker->seed ^= pWorker->seed >> 17;
+        pWorker->seed ^= pWorker->seed << 5;
+        first = pWorker->seed % count;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        Worker *pVictim = m_workers[(first + i) % count];
+        if (pVictim == pWorker) {
+            continue;
+        }
+        IRunnable *pTask = pVictim->deque.steal();
+        if (pTask != 0) {
+            if (pWorker != 0) {
+                pWorker->stolen.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                m_stolen.fetch_add(1, std::memory_order_relaxed);
+            }
+            return pTask;
+        }
+    }
+    return 0;
+}
+
+size_t ThreadPool::queueDepth() const
+{
+    size_t depth = m_queueSize.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < m_workers.size(); i++) {
+        depth += m_workers[i]->deque.size();
+    }
+    return depth;
+}
+
+uint64_t ThreadPool::executedCount() const
+{
+    uint64_t count = m_executed.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < m_workers.size(); i++) {
+        count += m_workers[i]->executed.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+uint64_t ThreadPool::stealCount() const
+{
+    uint64_t count = m_stolen.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < m_workers.size(); i++) {
+        count += m_workers[i]->stolen.load(std::memory_order_relaxed);
+    }
+    return count;
+}
+
+bool ThreadPool::isWorkerThread() const
+{
+    return s_pCurrentWorker != 0 && s_pCurrentWorker->pPool == this;
+}
+
+ThreadPool& ThreadPool::global()
+{
+    // Not destroyed on exit, static objects of other modules may still use it
+    static ThreadPool *pPool = new ThreadPool();
+    return *pPool;
+}
+
+unsigned ThreadPool::processorCount()
+{
+#ifdef WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? static_cast<unsigned>(count) : 1;
+#endif
+}
+
+} // namespace ucxx
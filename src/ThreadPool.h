@@ -0,0 +1,144 @@
+#ifndef UCXX_THREADPOOL_H
+#define UCXX_THREADPOOL_H
+
+//
+// Work-stealing thread pool
+//
+
+#include <stdint.h>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <type_traits>
+#include "IExecutor.h"
+#include "Mutex.h"
+#include "Sema.h"
+
+namespace ucxx {
+
+/**
+ * @brief Pool of worker threads executing submitted tasks.
+ * Each worker owns a work-stealing deque (see WorkStealingDeque). A task
+ * submitted from within a worker goes to the worker's own deque without
+ * any locking, tasks submitted from other threads go to a shared queue.
+ * A worker runs tasks of its own deque newest first, then takes tasks from
+ * the shared queue and finally steals the oldest tasks of other workers.
+ * Workers running out of tasks sleep on a semaphore until new tasks arrive.
+ *
+ * Tasks are either IRunnable objects, which are not owned by the pool and
+ * must stay valid until executed, or callables (functions, functors,
+ * lambdas) copied into the pool.
+ */
+class ThreadPool : public IExecutor
+{
+public:
+
+    /**
+     * @brief Construct a pool and start its workers.
+     * Workers whose threads cannot be created are left out, see
+     * threadCount(); without any worker, tasks run at submission.
+     * @param threadCount Number of workers, 0 for the number of processors.
+     */
+    explicit ThreadPool(unsigned threadCount = 0);
+
+    /**
+     * @brief Destructor.
+     * Waits until all submitted tasks (including tasks they submit in turn)
+     * are executed and then stops the workers.
+     */
+    ~ThreadPool();
+
+    /**
+     * @brief Submit a task.
+     * @param pRunnable Task to be run, not owned by the pool.
+     */
+    void submit(IRunnable *pRunnable);
+
+    /**
+     * @brief Submit a callable task.
+     * @param function Callable object invoked without arguments.
+     */
+    template <typename F>
+    typename std::enable_if<!std::is_convertible<F, IRunnable*>::value>::type submit(F function)
+    {
+        submit(new CallableTask<F>(function));
+    }
+
+    // IExecutor interface
+    void execute(IRunnable *pRunnable) { submit(pRunnable); }
+
+    /**
+     * @brief Execute one pending task in the calling thread.
+     * Intended for threads waiting for results of submitted tasks, which can
+     * help executing them instead of blocking a worker.
+     * @return false if no task was found.
+     */
+    bool runPendingTask();
+
+    /**
+     * @brief Returns number of running workers.
+     */
+    unsigned threadCount() const { return m_threadCount; }
+
+    /**
+     * @brief Returns approximate number of tasks waiting for execution.
+     */
+    size_t queueDepth() const;
+
+    /**
+     * @brief Returns number of tasks executed so far.
+     */
+    uint64_t executedCount() const;
+
+    /**
+     * @brief Returns number of tasks taken from deques of other workers.
+     */
+    uint64_t stealCount() const;
+
+    /**
+     * @brief Tells whether the calling thread is a worker of this pool.
+     */
+    bool isWorkerThread() const;
+
+    /**
+     * @brief Returns number of online processors.
+     */
+    static unsigned processorCount();
+
+    /**
+     * @brief Returns the process-wide pool, created on first use with a
+     * worker per processor.
+     * The pool is never destroyed, its workers are still running when
+     * the process exits.
+     */
+    static ThreadPool& global();
+
+private:
+
+    // Disable copying
+    ThreadPool(const ThreadPool&);
+    ThreadPool& operator =(const ThreadPool&);
+
+    struct Worker;
+
+    void work(Worker *pWorker);
+    IRunnable* findTask(Worker *pWorker);
+    IRunnable* steal(Worker *pWorker);
+
+    std::vector<Worker*> m_workers;     ///< Worker threads.
+    unsigned m_threadCount;             ///< Number of workers started.
+    Mutex m_mutex;                      ///< Protects the shared queue.
+    std::deque<IRunnable*> m_queue;     ///< Tasks submitted from outside of workers.
+    std::atomic<size_t> m_queueSize;    ///< Size of the shared queue, read without locking.
+    Semaphore m_semaphore;              ///< Sleeping workers wait here.
+    std::atomic<unsigned> m_idle;       ///< Number of workers going to sleep or sleeping.
+    std::atomic<bool> m_stopping;       ///< Workers exit once out of tasks.
+    std::atomic<uint64_t> m_executed;   ///< Tasks executed by non-worker threads.
+    std::atomic<uint64_t> m_stolen;     ///< Tasks stolen by non-worker threads.
+
+    static thread_local Worker *s_pCurrentWorker;   ///< Worker of the calling thread.
+};
+
+} // namespace ucxx
+
+#endif // UCXX_THREADPOOL_H
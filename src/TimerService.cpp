@@ -0,0 +1,303 @@
+#include "Clock.h"
+#include "Thread.h"
+#include "TimerService.h"
+
+namespace ucxx {
+
+/// Scheduled timer, linked into a wheel slot.
+struct TimerService::Timer
+{
+    uint32_t index;             ///< Position in the pool.
+    uint32_t generation;        ///< Incremented on release, invalidates old identifiers.
+    bool active;                ///< Linked into the wheel.
+    unsigned level;             ///< Wheel level.
+    unsigned slot;              ///< Slot within the level.
+    uint64_t expires;           ///< Expiration tick.
+    uint64_t period;            ///< Period in ticks, 0 for one-shot timers.
+    std::function<void()> function; ///< Callback.
+    Timer *pPrev;               ///< Previous timer in the slot.
+    Timer *pNext;               ///< Next timer in the slot.
+};
+
+/// Timer thread.
+class TimerService::Worker : public Thread
+{
+public:
+    Worker(TimerService *pService) : m_pService(pService) {}
+    void run() { m_pService->work(); }
+
+private:
+    TimerService *m_pService;
+};
+
+TimerService::TimerService(IExecutor *pExecutor, unsigned resolution)
+    : m_pExecutor(pExecutor),
+      m_resolution(resolution > 0 ? resolution : 1),
+      m_start(Clock::milliseconds()),
+      m_mutex("TimerService"),
+      m_tick(0),
+      m_wakeTick(0),
+      m_count(0),
+      m_stopping(false),
+      m_running(false)
+{
+    for (unsigned level = 0; level < Levels; level++) {
+        m_levelCounts[level] = 0;
+        for (unsigned slot = 0; slot < Slots; slot++) {
+            m_wheel[level][slot] = 0;
+        }
+    }
+
+    m_pWorker = new Worker(this);
+    m_pWorker->setName("ucxx-timer");
+    m_running = m_pWorker->start();
+}
+
+TimerService::~TimerService()
+{
+    {
+        MutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_cond.notifyOne();
+    }
+    m_pWorker->join();
+    delete m_pWorker;
+
+    for (size_t i = 0; i < m_timers.size(); i++) {
+        delete m_timers[i];
+    }
+}
+
+TimerId TimerService::schedule(IRunnable *pRunnable, unsigned delay, unsigned period)
+{
+    return add([pRunnable]() { pRunnable->run(); }, delay, period);
+}
+
+TimerId TimerService::add(const std::function<void()> &function, unsigned delay, unsigned period)
+{
+    if (!m_running) {
+        // Nothing would ever fire the timer
+        return 0;
+    }
+
+    MutexLocker locker(&m_mutex);
+
+    Timer *pTimer;
+    if (!m_freeTimers.empty()) {
+        pTimer = m_timers[m_freeTimers.back()];
+        m_freeTimers.pop_back();
+    } else {
+        pTimer = new Timer();
+        pTimer->index = static_cast<uint32_t>(m_timers.size());
+        pTimer->generation = 1;
+        m_timers.push_back(pTimer);
+    }
+
+    // The timer thread may lag behind the clock, never fire early
+    uint64_t now = currentTick();
+    pTimer->expires = (now > m_tick ? now : m_tick) + ticks(delay);
+    pTimer->period = period > 0 ? ticks(period) : 0;
+    pTimer->function = function;
+    insert(pTimer);
+    m_count++;
+
+    if (pTimer->expires < m_wakeTick || m_wakeTick == 0) {
+        m_cond.notifyOne();
+    }
+    return (static_cast<uint64_t>(pTimer->generation) << 32) | (pTimer->index + 1);
+}
+
+bool TimerService::cancel(TimerId id)
+{
+    uint32_t index = static_cast<uint32_t>(id & 0xFFFFFFFF);
+    uint32_t generation = static_cast<uint32_t>(id >> 32);
+
+    MutexLocker locker(&m_mutex);
+    if (index == 0 || index > m_timers.size()) {
+        return false;
+    }
+    Timer *pTimer = m_timers[index - 1];
+    if (pTimer->generation != generation || !pTimer->active) {
+        return false;
+    }
+    unlink(pTimer);
+    release(pTimer);
+    return true;
+}
+
+size_t TimerService::timerCount() const
+{
+    MutexLocker locker(&m_mutex);
+    return m_count;
+}
+
+void TimerService::work()
+{
+    std::vector<std::function<void()> > expired;
+
+    MutexLocker locker(&m_mutex);
+    while (!m_stopping) {
+        advance(currentTick(), expired);
+        if (!expired.empty()) {
+            m_mutex.unlock();
+            for (size_t i = 0; i < expired.size(); i++) {
+                if (m_pExecutor != 0) {
+                    executeCallable(m_pExecutor, expired[i]);
+                } else {
+                    expired[i]();
+                }
+            }
+            expired.clear();
+            m_mutex.lock();
+            continue;
+        }
+
+        // Sleep until the next slot holding timers (0 waits forever)
+        unsigned timeout = 0;
+        m_wakeTick = nextTick();
+        if (m_wakeTick > 0) {
+            timeout = Clock::remaining(m_start + m_wakeTick * m_resolution);
+            if (timeout == 0) {
+                continue;
+            }
+        }
+        m_cond.wait(&m_mutex, timeout);
+        m_wakeTick = 0;
+    }
+}
+
+uint64_t TimerService::currentTick() const
+{
+    return (Clock::milliseconds() - m_start) / m_resolution;
+}
+
+uint64_t TimerService::ticks(unsigned milliseconds) const
+{
+    // Round up, so that the delay is never shortened
+    uint64_t count = (static_cast<uint64_t>(milliseconds) + m_resolution - 1) / m_resolution;
+    return count > 0 ? count : 1;
+}
+
+void TimerService::insert(Timer *pTimer)
+{
+    uint64_t delta = pTimer->expires - m_tick;
+    const uint64_t maxDelta = (static_cast<uint64_t>(1) << (SlotBits * Levels)) - 1;
+    if (delta > maxDelta) {
+        delta = maxDelta;
+        pTimer->expires = m_tick + delta;
+    }
+
+    unsigned level = 0;
+    while (level < Levels - 1 && delta >= (static_cast<uint64_t>(1) << (SlotBits * (level + 1)))) {
+        level++;
+    }
+    unsigned slot = static_cast<unsigned>(pTimer->expires >> (SlotBits * level)) & (Slots - 1);
+
+    pTimer->level = level;
+    pTimer->slot = slot;
+    pTimer->active = true;
+    pTimer->pPrev = 0;
+    pTimer->pNext = m_wheel[level][slot];
+    if (pTimer->pNext != 0) {
+        pTimer->pNext->pPrev = pTimer;
+    }
+    m_wheel[level][slot] = pTimer;
+    m_levelCounts[level]++;
+}
+
+void TimerService::unlink(Timer *pTimer)
+{
+    if (pTimer->pPrev != 0) {
+        pTimer->pPrev->pNext = pTimer->pNext;
+    } else {
+        m_wheel[pTimer->level][pTimer->slot] = pTimer->pNext;
+    }
+    if (pTimer->pNext != 0) {
+        pTimer->pNext->pPrev = pTimer->pPrev;
+    }
+    pTimer->active = false;
+    m_levelCounts[pTimer->level]--;
+}
+
+void TimerService::release(Timer *pTimer)
+{
+    pTimer->function = std::function<void()>();
+    pTimer->generation++;
+    m_freeTimers.push_back(pTimer->index);
+    m_count--;
+}
+
+void TimerService::advance(uint64_t tick, std::vector<std::function<void()> > &expired)
+{
+    while (m_tick < tick) {
+        if (m_count == 0) {
+            m_tick = tick;
+            break;
+        }
+        if (m_levelCounts[0] == 0) {
+            // Nothing on the first level, skip to the end of its window
+            uint64_t windowEnd = m_tick | (Slots - 1);
+            if (windowEnd >= tick) {
+                m_tick = tick;
+                break;
+            }
+            m_tick = windowEnd;
+        }
+
+        m_tick++;
+        for (unsigned level = 1; level < Levels; level++) {
+            if ((m_tick & ((static_cast<uint64_t>(1) << (SlotBits * level)) - 1)) != 0) {
+                break;
+            }
+            cascade(level);
+        }
+
+        Timer *pTimer = m_wheel[0][m_tick & (Slots - 1)];
+        while (pTimer != 0) {
+            Timer *pNext = pTimer->pNext;
+            unlink(pTimer);
+            expired.push_back(pTimer->function);
+            if (pTimer->period > 0) {
+                pTimer->expires += pTimer->period;
+                insert(pTimer);
+            } else {
+                release(pTimer);
+            }
+            pTimer = pNext;
+        }
+    }
+}
+
+void TimerService::cascade(unsigned level)
+{
+    unsigned slot = static_cast<unsigned>(m_tick >> (SlotBits * level)) & (Slots - 1);
+    Timer *pTimer = m_wheel[level][slot];
+    m_wheel[level][slot] = 0;
+    while (pTimer != 0) {
+        Timer *pNext = pTimer->pNext;
+        m_levelCounts[level]--;
+        insert(pTimer);
+        pTimer = pNext;
+    }
+}
+
+uint64_t TimerService::nextTick() const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+
+    // Timers on coarser levels are due at the end of the window at the
+    // earliest, when they are redistributed.
+    uint64_t windowEnd = (m_tick | (Slots - 1)) + 1;
+    if (m_levelCounts[0] > 0) {
+        for (uint64_t tick = m_tick + 1; tick < windowEnd; tick++) {
+            if (m_wheel[0][tick & (Slots - 1)] != 0) {
+                return tick;
+            }
+        }
+    }
+    return windowEnd;
+}
+
+} // namespace ucxx
@@ -0,0 +1,145 @@
+#ifndef UCXX_TIMERSERVICE_H
+#define UCXX_TIMERSERVICE_H
+
+//
+// Timer service based on a hierarchical timing wheel
+//
+
+#include <stdint.h>
+#include <functional>
+#include <vector>
+#include <type_traits>
+#include "IExecutor.h"
+#include "Mutex.h"
+#include "ConditionVariable.h"
+
+namespace ucxx {
+
+/// Timer identifier, 0 is never a valid timer.
+typedef uint64_t TimerId;
+
+/**
+ * @brief Service running one-shot and periodic timers.
+ * Timers are kept in a hierarchical timing wheel: 4 levels of 256 slots,
+ * the first level covering the next 256 ticks one tick per slot, each
+ * further level covering 256 times longer spans. A timer is put into the
+ * slot its expiration falls into, and timers of a coarser level slot are
+ * redistributed into finer levels once time reaches the slot. Scheduling
+ * and cancelling are constant-time operations, whatever the number of
+ * timers, so the service suits e.g. deadlines of many connections, most
+ * of which are cancelled before they expire.
+ *
+ * Timers are driven by the monotonic Clock from a dedicated thread, which
+ * sleeps until the next non-empty slot. Callbacks run in that thread, or
+ * are handed over to an executor, and must not block it for long.
+ * A timer never fires earlier than requested, and late at most by the
+ * tick (resolution) plus scheduling delays. Delays are limited to
+ * 2^32 ticks (about 49 days at the default resolution).
+ */
+class TimerService
+{
+public:
+
+    /**
+     * @brief Construct the service and start its thread.
+     * If the thread cannot be created, scheduling fails, see isRunning().
+     * @param pExecutor Executor running the callbacks, null to run them
+     * in the timer thread.
+     * @param resolution Tick length in milliseconds.
+     */
+    explicit TimerService(IExecutor *pExecutor = 0, unsigned resolution = 1);
+
+    /**
+     * @brief Destructor.
+     * Stops the timer thread, timers not expired yet are discarded.
+     */
+    ~TimerService();
+
+    /**
+     * @brief Schedule a task.
+     * @param pRunnable Task to be run, not owned by the service; it must
+     * stay valid until the timer expires or is cancelled.
+     * @param delay Delay in milliseconds.
+     * @param period Period of a periodic timer in milliseconds, 0 for a
+     * one-shot timer.
+     * @return Timer identifier, 0 if the timer thread could not be started.
+     */
+    TimerId schedule(IRunnable *pRunnable, unsigned delay, unsigned period = 0);
+
+    /**
+     * @brief Schedule a callable.
+     * @param function Callable object invoked without arguments.
+     * @param delay Delay in milliseconds.
+     * @param period Period of a periodic timer in milliseconds, 0 for a
+     * one-shot timer.
+     * @return Timer identifier, 0 if the timer thread could not be started.
+     */
+    template <typename F>
+    typename std::enable_if<!std::is_convertible<F, IRunnable*>::value, TimerId>::type
+    schedule(F function, unsigned delay, unsigned period = 0)
+    {
+        return add(std::function<void()>(function), delay, period);
+    }
+
+    /**
+     * @brief Cancel a timer.
+     * A callback already running (or handed over to the executor) is not
+     * affected, but a periodic timer is not run again.
+     * @return false if the timer has already expired or been cancelled.
+     */
+    bool cancel(TimerId id);
+
+    /**
+     * @brief Returns number of scheduled timers.
+     */
+    size_t timerCount() const;
+
+    /**
+     * @brief Tells whether the timer thread has been started.
+     */
+    bool isRunning() const { return m_running; }
+
+private:
+
+    // Disable copying
+    TimerService(const TimerService&);
+    TimerService& operator =(const TimerService&);
+
+    static const unsigned Levels = 4;
+    static const unsigned SlotBits = 8;
+    static const unsigned Slots = 1 << SlotBits;
+
+    struct Timer;
+    class Worker;
+
+    TimerId add(const std::function<void()> &function, unsigned delay, unsigned period);
+    void work();
+    uint64_t currentTick() const;
+    uint64_t ticks(unsigned milliseconds) const;
+    void insert(Timer *pTimer);
+    void unlink(Timer *pTimer);
+    void release(Timer *pTimer);
+    void advance(uint64_t tick, std::vector<std::function<void()> > &expired);
+    void cascade(unsigned level);
+    uint64_t nextTick() const;
+
+    IExecutor *m_pExecutor;         ///< Executor of callbacks, null for the timer thread.
+    unsigned m_resolution;          ///< Tick length in milliseconds.
+    uint64_t m_start;               ///< Clock time of tick zero.
+    mutable Mutex m_mutex;          ///< Protects the wheel.
+    ConditionVariable m_cond;       ///< The timer thread sleeps here.
+    Timer *m_wheel[Levels][Slots];  ///< Slot lists of timers.
+    size_t m_levelCounts[Levels];   ///< Number of timers on each level.
+    uint64_t m_tick;                ///< Last tick processed.
+    uint64_t m_wakeTick;            ///< Tick the timer thread sleeps until.
+    std::vector<Timer*> m_timers;   ///< Timer pool, indexed by identifier.
+    std::vector<uint32_t> m_freeTimers; ///< Unused pool entries.
+    size_t m_count;                 ///< Number of scheduled timers.
+    bool m_stopping;                ///< Timer thread exits.
+    bool m_running;                 ///< Timer thread started.
+    Worker *m_pWorker;              ///< Timer thread.
+};
+
+} // namespace ucxx
+
+#endif // UCXX_TIMERSERVICE_H
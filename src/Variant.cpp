@@ -182,6 +182,43 @@ void Variant::clear()
     m_type = Type_Invalid;
 }
 
+void Variant::swap(Variant &variant)
+{
+    Type type = m_type;
+    m_type = variant.m_type;
+    variant.m_type = type;
+
+    Data data = m_data;
+    m_data = variant.m_data;
+    variant.m_data = data;
+}
+
+bool Variant::operator ==(const Variant &variant) const
+{
+    if (m_type != variant.m_type) {
+        return false;
+    }
+
+    switch (m_type) {
+    case Type_Boolean:
+        return m_data.b == variant.m_data.b;
+    case Type_Integer:
+        return m_data.i == variant.m_data.i;
+    case Type_Real:
+        return m_data.r == variant.m_data.r;
+    case Type_String:
+        return string() == variant.string();
+    case Type_List:
+        return list() == variant.list();
+    case Type_Map:
+        return map() == variant.map();
+    default:
+        break;
+    }
+
+    return true;
+}
+
 bool Variant::toBoolean(bool def) const
 {
     bool res = def;
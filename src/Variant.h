@@ -65,6 +65,20 @@ public:
     bool isNull() const { return m_type == Type_Null; }
     void clear();
 
+    /**
+     * @brief Exchange contents with another variant.
+     * This does not copy any string, list or map data.
+     * @param variant Variant to swap with.
+     */
+    void swap(Variant &variant);
+
+    /**
+     * @brief Compare type and value (recursively for lists and maps).
+     * Values of different types are never equal, e.g. Integer 1 and Real 1.0.
+     */
+    bool operator ==(const Variant &variant) const;
+    bool operator !=(const Variant &variant) const { return !operator ==(variant); }
+
     bool toBoolean(bool def = false) const;
     int toInteger(int def = 0) const;
     double toReal(double def = 0.0) const;
@@ -0,0 +1,194 @@
+#include <string.h>
+#include "Endian.h"
+#include "Checksum.h"
+#include "ByteArraySerializer.h"
+#include "VariantBatch.h"
+
+namespace ucxx {
+
+const char cHeaderMagic[] = "UCXB";
+const char cFooterMagic[] = "UCXI";
+const size_t cMagicSize = 4;
+
+// Index offset, record count, flags and magic.
+const size_t cFooterSize = sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint32_t) + cMagicSize;
+
+// Batch flags.
+const uint32_t cFlagChecksums = 0x01;
+
+VariantBatch::VariantBatch(bool checksums)
+    : m_buffer(cHeaderMagic, cMagicSize),
+      m_sealed(false),
+      m_offsets(),
+      m_crcs(),
+      m_end(cMagicSize),
+      m_checksums(checksums),
+      m_valid(true)
+{
+}
+
+VariantBatch::VariantBatch(const ByteArray &ba)
+    : m_buffer(),
+      m_sealed(false),
+      m_offsets(),
+      m_crcs(),
+      m_end(0),
+      m_checksums(false),
+      m_valid(false)
+{
+    open(ba);
+}
+
+bool VariantBatch::open(const ByteArray &ba)
+{
+    m_buffer = ByteArray(cHeaderMagic, cMagicSize);
+    m_sealed = false;
+    m_offsets.clear();
+    m_crcs.clear();
+    m_end = cMagicSize;
+    m_checksums = false;
+    m_valid = false;
+
+    size_t size = ba.size();
+    const char *pData = ba.constData();
+    if (size < cMagicSize + cFooterSize
+            || memcmp(pData, cHeaderMagic, cMagicSize) != 0
+            || memcmp(pData + size - cMagicSize, cFooterMagic, cMagicSize) != 0) {
+        return false;
+    }
+
+    const char *pFooter = pData + size - cFooterSize;
+    uint64_t indexOffset = loadLittleEndian<uint64_t>(pFooter);
+    uint32_t count = loadLittleEndian<uint32_t>(pFooter + sizeof(uint64_t));
+    uint32_t flags = loadLittleEndian<uint32_t>(pFooter + sizeof(uint64_t) + sizeof(uint32_t));
+
+    bool checksums = (flags & cFlagChecksums) != 0;
+    size_t entrySize = sizeof(uint64_t) + (checksums ? sizeof(uint32_t) : 0);
+    size_t indexEnd = size - cFooterSize;
+    if (indexOffset < cMagicSize || indexOffset > indexEnd
+            || (indexEnd - indexOffset) / entrySize != count
+            || (indexEnd - indexOffset) % entrySize != 0) {
+        return false;
+    }
+
+    std::vector<uint64_t> offsets(count);
+    std::vector<uint32_t> crcs(checksums ? count : 0);
+    const char *pEntry = pData + indexOffset;
+    uint64_t previous = cMagicSize;
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t offset = loadLittleEndian<uint64_t>(pEntry);
+        if (offset < previous || offset >= indexOffset) {
+            // Records must be stored in order
+            return false;
+        }
+        offsets[i] = previous = offset;
+        if (checksums) {
+            crcs[i] = loadLittleEndian<uint32_t>(pEntry + sizeof(uint64_t));
+        }
+        pEntry += entrySize;
+    }
+
+    m_buffer = ba;
+    m_sealed = true;
+    m_offsets.swap(offsets);
+    m_crcs.swap(crcs);
+    m_end = indexOffset;
+    m_checksums = checksums;
+    m_valid = true;
+    return true;
+}
+
+void VariantBatch::append(const Variant &value)
+{
+    if (m_sealed) {
+        // Drop the index, it will be written again after the new record
+        m_buffer.resize(m_end);
+        m_sealed = false;
+    }
+
+    ByteArraySerializer serializer;
+    serializer.pushValue(value);
+    const ByteArray &record = serializer.byteArray();
+
+    m_offsets.push_back(m_end);
+    if (m_checksums) {
+        m_crcs.push_back(crc32(record.constData(), record.size()));
+    }
+    m_buffer.append(record);
+    m_end += record.size();
+}
+
+bool VariantBatch::record(size_t i, Variant &value) const
+{
+    if (i >= m_offsets.size()) {
+        return false;
+    }
+
+    const char *pRecord = m_buffer.constData() + m_offsets[i];
+    size_t size = recordSize(i);
+    if (m_checksums && crc32(pRecord, size) != m_crcs[i]) {
+        return false;
+    }
+
+    ByteArraySerializer serializer;
+    serializer.attach(pRecord, size);
+    return serializer.popValue(value);
+}
+
+bool VariantBatch::records(size_t first, size_t count, VariantList &values) const
+{
+    if (first > m_offsets.size() || count > m_offsets.size() - first) {
+        return false;
+    }
+
+    for (size_t i = first; i < first + count; i++) {
+        values.push_back(Variant());
+        if (!record(i, values.back())) {
+            values.pop_back();
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t VariantBatch::recordSize(size_t i) const
+{
+    if (i >= m_offsets.size()) {
+        return 0;
+    }
+    uint64_t next = (i + 1 < m_offsets.size()) ? m_offsets[i + 1] : m_end;
+    return next - m_offsets[i];
+}
+
+const ByteArray& VariantBatch::byteArray() const
+{
+    if (!m_sealed) {
+        writeIndex();
+    }
+    return m_buffer;
+}
+
+void VariantBatch::writeIndex() const
+{
+    size_t entrySize = sizeof(uint64_t) + (m_checksums ? sizeof(uint32_t) : 0);
+    size_t indexSize = m_offsets.size() * entrySize;
+
+    m_buffer.resize(m_end + indexSize + cFooterSize);
+    char *pEntry = m_buffer.data() + m_end;
+    for (size_t i = 0; i < m_offsets.size(); i++) {
+        storeLittleEndian<uint64_t>(pEntry, m_offsets[i]);
+        if (m_checksums) {
+            storeLittleEndian<uint32_t>(pEntry + sizeof(uint64_t), m_crcs[i]);
+        }
+        pEntry += entrySize;
+    }
+
+    storeLittleEndian<uint64_t>(pEntry, m_end);
+    storeLittleEndian<uint32_t>(pEntry + sizeof(uint64_t), (uint32_t)m_offsets.size());
+    storeLittleEndian<uint32_t>(pEntry + sizeof(uint64_t) + sizeof(uint32_t),
+                                m_checksums ? cFlagChecksums : 0);
+    memcpy(pEntry + sizeof(uint64_t) + 2 * sizeof(uint32_t), cFooterMagic, cMagicSize);
+    m_sealed = true;
+}
+
+} // namespace ucxx
@@ -0,0 +1,121 @@
+#ifndef UCXX_VARIANTBATCH_H
+#define UCXX_VARIANTBATCH_H
+
+//
+// Indexed container of serialized variant records
+//
+
+#include <stdint.h>
+#include <vector>
+#include "Variant.h"
+#include "ByteArray.h"
+
+namespace ucxx {
+
+/**
+ * @brief Batch of serialized variants with random access.
+ * Records are encoded one after another in ByteArraySerializer format and
+ * followed by an index of record offsets (and optionally CRC-32 checksums
+ * of the records), so any record can be located in constant time:
+ *
+ *     "UCXB"                   header magic
+ *     record 0 .. record N-1   encoded values
+ *     N x { u64 offset [, u32 crc] }
+ *     u64 index offset, u32 N, u32 flags, "UCXI"
+ *
+ * All numbers are little-endian. Appending a record only overwrites the
+ * trailing index, records already stored are never moved or rewritten.
+ * Decoding methods are const and may be called concurrently from several
+ * threads (e.g. each decoding its own range), but not concurrently with
+ * append() or byteArray().
+ */
+class VariantBatch
+{
+public:
+
+    /**
+     * @brief Construct an empty batch.
+     * @param checksums Store CRC-32 checksum for each record.
+     */
+    VariantBatch(bool checksums = false);
+
+    /**
+     * @brief Open an existing batch.
+     * Check isValid() to find out whether the data was recognized.
+     * @param ba Serialized batch as returned by byteArray().
+     */
+    VariantBatch(const ByteArray &ba);
+
+    /**
+     * @brief Open an existing batch replacing current content.
+     * @param ba Serialized batch.
+     * @return false if the data is not a valid batch, the batch is empty then.
+     */
+    bool open(const ByteArray &ba);
+
+    /**
+     * @brief Tells whether the batch has been opened successfully.
+     */
+    bool isValid() const { return m_valid; }
+
+    /**
+     * @brief Tells whether records carry checksums.
+     */
+    bool hasChecksums() const { return m_checksums; }
+
+    /**
+     * @brief Returns number of records.
+     */
+    size_t count() const { return m_offsets.size(); }
+
+    /**
+     * @brief Append a record.
+     * @param value Value to be stored.
+     */
+    void append(const Variant &value);
+
+    /**
+     * @brief Decode a single record.
+     * @param i Record index.
+     * @param value Decoded value.
+     * @return false if index is out of range, the record is corrupted
+     *         or its checksum does not match.
+     */
+    bool record(size_t i, Variant &value) const;
+
+    /**
+     * @brief Decode a range of records.
+     * @param first Index of the first record.
+     * @param count Number of records.
+     * @param values List the decoded values are appended to.
+     * @return false if the range is out of bounds or any record failed to decode.
+     */
+    bool records(size_t first, size_t count, VariantList &values) const;
+
+    /**
+     * @brief Returns encoded size of a record in bytes.
+     */
+    size_t recordSize(size_t i) const;
+
+    /**
+     * @brief Returns the serialized batch.
+     * The index is written lazily here, after the last append.
+     */
+    const ByteArray& byteArray() const;
+
+private:
+
+    void writeIndex() const;
+
+    mutable ByteArray m_buffer;         ///< Header, records and (when sealed) the index.
+    mutable bool m_sealed;              ///< The buffer ends with an up-to-date index.
+    std::vector<uint64_t> m_offsets;    ///< Record offsets.
+    std::vector<uint32_t> m_crcs;       ///< Record checksums.
+    size_t m_end;                       ///< Offset past the last record.
+    bool m_checksums;                   ///< Checksums are stored.
+    bool m_valid;                       ///< Batch has been parsed successfully.
+};
+
+} // namespace ucxx
+
+#endif // UCXX_VARIANTBATCH_H
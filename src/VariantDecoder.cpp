@@ -0,0 +1,270 @@
+#include <string.h>
+#include "Endian.h"
+#include "WireFormat.h"
+#include "VariantDecoder.h"
+
+namespace ucxx {
+
+VariantDecoder::VariantDecoder()
+{
+    reset();
+}
+
+bool VariantDecoder::feed(const char *pData, size_t size)
+{
+    if (m_error) {
+        return false;
+    }
+
+    const char *pEnd = pData + size;
+    while (pData < pEnd) {
+        switch (m_state) {
+        case State_Signature:
+            if (!beginValue(*pData++)) {
+                m_error = true;
+                return false;
+            }
+            break;
+        case State_Payload: {
+            size_t bytes = m_need - m_have;
+            if (bytes > (size_t)(pEnd - pData)) {
+                bytes = pEnd - pData;
+            }
+            memcpy(m_payload + m_have, pData, bytes);
+            m_have += bytes;
+            pData += bytes;
+            if (m_have == m_need && !endPayload()) {
+                m_error = true;
+                return false;
+            }
+            break;
+        }
+        case State_String: {
+            size_t bytes = m_remaining;
+            if (bytes > (size_t)(pEnd - pData)) {
+                bytes = pEnd - pData;
+            }
+            m_pString->append(pData, bytes);
+            m_remaining -= bytes;
+            pData += bytes;
+            if (m_remaining == 0) {
+                completeValue();
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool VariantDecoder::feed(const ByteArray &ba)
+{
+    return feed(ba.constData(), ba.size());
+}
+
+bool VariantDecoder::popValue(Variant &value)
+{
+    if (m_completed == 0) {
+        return false;
+    }
+
+    value.swap(m_values.front());
+    m_values.pop_front();
+    --m_completed;
+    return true;
+}
+
+bool VariantDecoder::isPartial() const
+{
+    return m_values.size() > m_completed;
+}
+
+void VariantDecoder::reset()
+{
+    m_state = State_Signature;
+    m_type = Variant::Type_Invalid;
+    m_pValue = 0;
+    m_pString = 0;
+    m_readingKey = false;
+    m_keyEncoding = 0;
+    m_keyId = 0;
+    m_key.clear();
+    m_keys.clear();
+    m_need = 0;
+    m_have = 0;
+    m_remaining = 0;
+    m_stack.clear();
+    m_values.clear();
+    m_completed = 0;
+    m_error = false;
+}
+
+bool VariantDecoder::beginValue(char signature)
+{
+    m_readingKey = !m_stack.empty() && m_stack.back().expectKey;
+    m_keyEncoding = signature;
+    m_have = 0;
+
+    if (m_readingKey && (signature == cKeyDefinitionSignature || signature == cKeyReferenceSignature)) {
+        // Dictionary id, followed by the key string for definitions
+        m_type = Variant::Type_String;
+        m_pValue = 0;
+        m_need = sizeof(uint16_t) + (signature == cKeyDefinitionSignature ? sizeof(unsigned) : 0);
+        m_state = State_Payload;
+        return true;
+    }
+
+    if (!signatureType(signature, m_type)) {
+        return false;
+    }
+
+    if (m_readingKey) {
+        if (m_type != Variant::Type_String) {
+            // Map keys must be strings
+            return false;
+        }
+        m_pValue = 0;
+    } else {
+        m_pValue = slot();
+    }
+
+    switch (m_type) {
+    case Variant::Type_Invalid:
+    case Variant::Type_Null:
+        *m_pValue = Variant(m_type);
+        completeValue();
+        return true;
+    case Variant::Type_Boolean:
+        m_need = sizeof(bool);
+        break;
+    case Variant::Type_Integer:
+        m_need = sizeof(int);
+        break;
+    case Variant::Type_Real:
+        m_need = sizeof(double);
+        break;
+    default:
+        // String length or container size
+        m_need = sizeof(unsigned);
+        break;
+    }
+
+    m_state = State_Payload;
+    return true;
+}
+
+bool VariantDecoder::endPayload()
+{
+    if (m_keyEncoding == cKeyReferenceSignature) {
+        uint16_t id = loadLittleEndian<uint16_t>(m_payload);
+        if (id >= m_keys.size()) {
+            // Undefined key
+            return false;
+        }
+        m_key = m_keys[id];
+        completeValue();
+        return true;
+    }
+
+    switch (m_type) {
+    case Variant::Type_Boolean:
+        *m_pValue = loadLittleEndian<bool>(m_payload);
+        break;
+    case Variant::Type_Integer:
+        *m_pValue = loadLittleEndian<int>(m_payload);
+        break;
+    case Variant::Type_Real:
+        *m_pValue = loadLittleEndian<double>(m_payload);
+        break;
+    case Variant::Type_String: {
+        size_t lengthOffset = 0;
+        if (m_keyEncoding == cKeyDefinitionSignature) {
+            m_keyId = loadLittleEndian<uint16_t>(m_payload);
+            lengthOffset = sizeof(uint16_t);
+        }
+        if (m_readingKey) {
+            m_pString = &m_key;
+            m_key.clear();
+        } else {
+            *m_pValue = Variant(Variant::Type_String);
+            m_pString = &m_pValue->string();
+        }
+        m_remaining = loadLittleEndian<unsigned>(m_payload + lengthOffset);
+        if (m_remaining > 0) {
+            m_state = State_String;
+            return true;
+        }
+        break;
+    }
+    case Variant::Type_List:
+    case Variant::Type_Map: {
+        *m_pValue = Variant(m_type);
+        unsigned size = loadLittleEndian<unsigned>(m_payload);
+        if (size > 0) {
+            Frame frame;
+            frame.pContainer = m_pValue;
+            frame.remaining = size;
+            frame.expectKey = m_type == Variant::Type_Map;
+            m_stack.push_back(frame);
+            m_state = State_Signature;
+            return true;
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    completeValue();
+    return true;
+}
+
+void VariantDecoder::completeValue()
+{
+    m_state = State_Signature;
+
+    if (m_readingKey) {
+        if (m_keyEncoding == cKeyDefinitionSignature) {
+            if (m_keyId >= m_keys.size()) {
+                m_keys.resize(m_keyId + 1);
+            }
+            m_keys[m_keyId] = m_key;
+        }
+        // Map value follows the key
+        m_readingKey = false;
+        m_stack.back().expectKey = false;
+        return;
+    }
+
+    // Completing the last element of a container completes the container as well
+    while (!m_stack.empty()) {
+        Frame &frame = m_stack.back();
+        frame.expectKey = frame.pContainer->type() == Variant::Type_Map;
+        if (--frame.remaining > 0) {
+            return;
+        }
+        m_stack.pop_back();
+    }
+
+    ++m_completed;
+}
+
+Variant* VariantDecoder::slot()
+{
+    if (m_stack.empty()) {
+        m_values.push_back(Variant());
+        return &m_values.back();
+    }
+
+    Variant *pContainer = m_stack.back().pContainer;
+    if (pContainer->type() == Variant::Type_List) {
+        pContainer->list().push_back(Variant());
+        return &pContainer->list().back();
+    }
+    return &pContainer->map()[m_key];
+}
+
+} // namespace ucxx
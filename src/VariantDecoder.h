@@ -0,0 +1,117 @@
+#ifndef UCXX_VARIANTDECODER_H
+#define UCXX_VARIANTDECODER_H
+
+//
+// Incremental (resumable) variant decoder
+//
+
+#include <list>
+#include <vector>
+#include "Variant.h"
+#include "ByteArray.h"
+
+namespace ucxx {
+
+/**
+ * @brief Resumable decoder of the serialized variant format.
+ * The decoder accepts encoded data in arbitrary chunks, as produced by
+ * ByteArraySerializer or StreamSerializer, and builds the values while
+ * the bytes arrive. Decoding state (including the nesting of partially
+ * decoded lists and maps) is kept on an explicit stack, so running out of
+ * data in the middle of a value simply suspends decoding until the next
+ * chunk is fed. Consumed input is not retained.
+ * Map keys encoded via the key dictionary are understood as well.
+ */
+class VariantDecoder
+{
+public:
+
+    VariantDecoder();
+
+    /**
+     * @brief Feed the next chunk of encoded data.
+     * @param pData Encoded data.
+     * @param size Number of bytes.
+     * @return false if a format error has been detected.
+     */
+    bool feed(const char *pData, size_t size);
+
+    /**
+     * @brief Feed the next chunk of encoded data.
+     * @param ba Encoded data.
+     * @return false if a format error has been detected.
+     */
+    bool feed(const ByteArray &ba);
+
+    /**
+     * @brief Take the next completely decoded value.
+     * @param value Decoded value.
+     * @return false if no complete value is available yet.
+     */
+    bool popValue(Variant &value);
+
+    /**
+     * @brief Returns number of completely decoded values waiting to be taken.
+     */
+    size_t available() const { return m_completed; }
+
+    /**
+     * @brief Tells whether the decoder is in the middle of a value.
+     */
+    bool isPartial() const;
+
+    /**
+     * @brief Tells whether a format error has been detected.
+     * Once in error state the decoder ignores any further data until reset.
+     */
+    bool isError() const { return m_error; }
+
+    /**
+     * @brief Drop all decoded and partially decoded values and clear the error state.
+     * The key dictionary is cleared as well.
+     */
+    void reset();
+
+private:
+
+    /// Decoding states.
+    enum State {
+        State_Signature,    ///< Waiting for a type signature.
+        State_Payload,      ///< Collecting a fixed-size payload.
+        State_String        ///< Collecting string characters.
+    };
+
+    /// Partially decoded list or map.
+    struct Frame {
+        Variant *pContainer;    ///< List or map being filled.
+        unsigned remaining;     ///< Number of elements still expected.
+        bool expectKey;         ///< Next value is a map key.
+    };
+
+    bool beginValue(char signature);
+    bool endPayload();
+    void completeValue();
+    Variant* slot();
+
+    State m_state;                  ///< Current decoding state.
+    Variant::Type m_type;           ///< Type of the value being decoded.
+    Variant *m_pValue;              ///< Value being decoded.
+    std::string *m_pString;         ///< String being collected.
+    bool m_readingKey;              ///< Current string is a map key.
+    char m_keyEncoding;             ///< Signature the current key is encoded with.
+    unsigned m_keyId;               ///< Dictionary id of the key being defined.
+    std::string m_key;              ///< Last decoded map key.
+    std::vector<std::string> m_keys;///< Key dictionary.
+    char m_payload[8];              ///< Fixed-size payload being collected.
+    size_t m_need;                  ///< Payload size.
+    size_t m_have;                  ///< Payload bytes collected so far.
+    size_t m_remaining;             ///< String characters still expected.
+    std::vector<Frame> m_stack;     ///< Nesting of partially decoded containers.
+    std::list<Variant> m_values;    ///< Decoded values, last one may be partial.
+    size_t m_completed;             ///< Number of complete values in the list.
+    bool m_error;                   ///< Format error flag.
+};
+
+} // namespace ucxx
+
+#endif // UCXX_VARIANTDECODER_H
@@ -0,0 +1,188 @@
+#include <iterator>
+#include "VariantDiff.h"
+
+namespace ucxx {
+
+namespace {
+
+void addSet(const VariantList &path, const Variant &value, VariantList &changes)
+{
+    changes.push_back(Variant(Variant::Type_List));
+    VariantList &change = changes.back().list();
+    change.push_back(path);
+    change.push_back(value);
+}
+
+void addRemove(const VariantList &path, VariantList &changes)
+{
+    changes.push_back(Variant(Variant::Type_List));
+    changes.back().list().push_back(path);
+}
+
+void diffValues(const Variant &from, const Variant &to, VariantList &path, VariantList &changes)
+{
+    if (from.type() != to.type()) {
+        addSet(path, to, changes);
+        return;
+    }
+
+    switch (to.type()) {
+    case Variant::Type_Map: {
+        // Both maps are ordered by key, walk them side by side
+        const VariantMap &a = from.map();
+        const VariantMap &b = to.map();
+        VariantMap::const_iterator i = a.begin();
+        VariantMap::const_iterator j = b.begin();
+        while (i != a.end() || j != b.end()) {
+            if (j == b.end() || (i != a.end() && i->first < j->first)) {
+                path.push_back(i->first);
+                addRemove(path, changes);
+                path.pop_back();
+                ++i;
+            } else if (i == a.end() || j->first < i->first) {
+                path.push_back(j->first);
+                addSet(path, j->second, changes);
+                path.pop_back();
+                ++j;
+            } else {
+                path.push_back(j->first);
+                diffValues(i->second, j->second, path, changes);
+                path.pop_back();
+                ++i;
+                ++j;
+            }
+        }
+        break;
+    }
+    case Variant::Type_List: {
+        const VariantList &a = from.list();
+        const VariantList &b = to.list();
+        VariantList::const_iterator i = a.begin();
+        VariantList::const_iterator j = b.begin();
+        int index = 0;
+        for (; i != a.end() && j != b.end(); ++i, ++j, ++index) {
+            path.push_back(index);
+            diffValues(*i, *j, path, changes);
+            path.pop_back();
+        }
+        for (; j != b.end(); ++j, ++index) {
+            path.push_back(index);
+            addSet(path, *j, changes);
+            path.pop_back();
+        }
+        // Removed tail, last element first so the indexes stay valid
+        for (int last = static_cast<int>(a.size()) - 1; last >= index; --last) {
+            path.push_back(last);
+            addRemove(path, changes);
+            path.pop_back();
+        }
+        break;
+    }
+    default:
+        if (from != to) {
+            addSet(path, to, changes);
+        }
+        break;
+    }
+}
+
+// Find list element, index equal to the size yields end().
+bool listPosition(VariantList &list, const Variant &key, VariantList::iterator &it)
+{
+    if (key.type() != Variant::Type_Integer || key.toInteger() < 0 ||
+            static_cast<size_t>(key.toInteger()) > list.size()) {
+        return false;
+    }
+    it = list.begin();
+    std::advance(it, key.toInteger());
+    return true;
+}
+
+bool applyChange(Variant &root, const VariantList &change)
+{
+    if (change.empty() || change.size() > 2 || change.front().type() != Variant::Type_List) {
+        return false;
+    }
+    const VariantList &path = change.front().list();
+    bool remove = change.size() == 1;
+
+    if (path.empty()) {
+        if (remove) {
+            return false;
+        }
+        root = change.back();
+        return true;
+    }
+
+    // Walk to the parent of the changed value
+    Variant *pParent = &root;
+    VariantList::const_iterator last = --path.end();
+    for (VariantList::const_iterator it = path.begin(); it != last; ++it) {
+        if (pParent->type() == Variant::Type_Map && it->type() == Variant::Type_String) {
+            VariantMap::iterator pos = pParent->map().find(it->string());
+            if (pos == pParent->map().end()) {
+                return false;
+            }
+            pParent = &pos->second;
+        } else if (pParent->type() == Variant::Type_List) {
+            VariantList::iterator pos;
+            if (!listPosition(pParent->list(), *it, pos) || pos == pParent->list().end()) {
+                return false;
+            }
+            pParent = &*pos;
+        } else {
+            return false;
+        }
+    }
+
+    if (pParent->type() == Variant::Type_Map && last->type() == Variant::Type_String) {
+        if (remove) {
+            return pParent->map().erase(last->string()) > 0;
+        }
+        pParent->map()[last->string()] = change.back();
+        return true;
+    }
+
+    if (pParent->type() == Variant::Type_List) {
+        VariantList &list = pParent->list();
+        VariantList::iterator pos;
+        if (!listPosition(list, *last, pos)) {
+            return false;
+        }
+        if (remove) {
+            if (pos == list.end()) {
+                return false;
+            }
+            list.erase(pos);
+        } else if (pos == list.end()) {
+            list.push_back(change.back());
+        } else {
+            *pos = change.back();
+        }
+        return true;
+    }
+
+    return false;
+}
+
+} // namespace
+
+bool diffVariants(const Variant &from, const Variant &to, VariantList &changes)
+{
+    changes.clear();
+    VariantList path;
+    diffValues(from, to, path, changes);
+    return !changes.empty();
+}
+
+bool patchVariant(Variant &value, const VariantList &changes)
+{
+    for (VariantList::const_iterator it = changes.begin(); it != changes.end(); ++it) {
+        if (it->type() != Variant::Type_List || !applyChange(value, it->list())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace ucxx
@@ -0,0 +1,46 @@
+#ifndef UCXX_VARIANTDIFF_H
+#define UCXX_VARIANTDIFF_H
+
+//
+// Difference between two variants
+//
+
+#include "Variant.h"
+
+namespace ucxx {
+
+/*
+ * A change set is a list of changes, each change being a list itself:
+ *
+ *   [path, value]    Set the value at the path
+ *   [path]           Remove the value at the path
+ *
+ * The path is a list of map keys (String) and list indexes (Integer)
+ * leading from the root to the changed value, an empty path addresses
+ * the root itself. Setting a list element at index equal to the list size
+ * appends the element. Changes are applied in order.
+ */
+
+/**
+ * @brief Compute changes turning one value into another.
+ * Only the changed parts of maps and lists are recorded, a value whose
+ * type differs is replaced as a whole.
+ * @param from Original value.
+ * @param to New value.
+ * @param changes Resulting change set, cleared first.
+ * @return true if the values differ.
+ */
+bool diffVariants(const Variant &from, const Variant &to, VariantList &changes);
+
+/**
+ * @brief Apply changes to a value.
+ * @param value Value to be modified.
+ * @param changes Change set produced by diffVariants().
+ * @return false if the change set is malformed or does not match the value,
+ * the changes preceding the failing one remain applied.
+ */
+bool patchVariant(Variant &value, const VariantList &changes);
+
+} // namespace ucxx
+
+#endif // UCXX_VARIANTDIFF_H
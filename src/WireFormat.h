@@ -0,0 +1,89 @@
+#ifndef UCXX_WIREFORMAT_H
+#define UCXX_WIREFORMAT_H
+
+//
+// Binary variant encoding shared by the serializers
+//
+
+#include "Variant.h"
+
+namespace ucxx {
+
+/*
+ * Every encoded value starts with a single-character type signature
+ * followed by the type-specific payload (all numbers are little-endian):
+ *
+ *   X            Invalid
+ *   N            Null
+ *   B <u8>       Boolean (0 or 1)
+ *   I <i32>      Integer
+ *   R <f64>      Real
+ *   S <u32> ...  String, length followed by the characters
+ *   L <u32> ...  List, number of elements followed by the elements
+ *   M <u32> ...  Map, number of entries followed by key (String) / value pairs
+ *
+ * When the key dictionary is enabled, a map key may also be encoded as:
+ *
+ *   D <u16> <u32> ...  Key definition: dictionary id, length and characters
+ *   K <u16>            Key reference: id of a previously defined key
+ *
+ * The dictionary lives as long as the stream (serializer instance), so
+ * each distinct key is transmitted in full only once.
+ */
+
+/// Signature of a key definition.
+const char cKeyDefinitionSignature = 'D';
+
+/// Signature of a key reference.
+const char cKeyReferenceSignature = 'K';
+
+/// Maximum number of keys in the dictionary, other keys are sent as strings.
+const unsigned cMaxKeyDictionarySize = 0x10000;
+
+/**
+ * @brief Returns the wire signature of a variant type.
+ * @param type Variant type.
+ * @return Signature character.
+ */
+inline char typeSignature(Variant::Type type)
+{
+    switch (type) {
+    case Variant::Type_Null:    return 'N';
+    case Variant::Type_Boolean: return 'B';
+    case Variant::Type_Integer: return 'I';
+    case Variant::Type_Real:    return 'R';
+    case Variant::Type_String:  return 'S';
+    case Variant::Type_List:    return 'L';
+    case Variant::Type_Map:     return 'M';
+    default:
+        break;
+    }
+    return 'X';
+}
+
+/**
+ * @brief Decode a wire signature.
+ * @param signature Signature character.
+ * @param type Decoded variant type.
+ * @return false if the signature is not recognized.
+ */
+inline bool signatureType(char signature, Variant::Type &type)
+{
+    switch (signature) {
+    case 'X': type = Variant::Type_Invalid; break;
+    case 'N': type = Variant::Type_Null;    break;
+    case 'B': type = Variant::Type_Boolean; break;
+    case 'I': type = Variant::Type_Integer; break;
+    case 'R': type = Variant::Type_Real;    break;
+    case 'S': type = Variant::Type_String;  break;
+    case 'L': type = Variant::Type_List;    break;
+    case 'M': type = Variant::Type_Map;     break;
+    default:
+        return false;
+    }
+    return true;
+}
+
+} // namespace ucxx
+
+#endif // UCXX_WIREFORMAT_H
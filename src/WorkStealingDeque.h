@@ -0,0 +1,167 @@
+#ifndef UCXX_WORKSTEALINGDEQUE_H
+#define UCXX_WORKSTEALINGDEQUE_H
+
+//
+// Lock-free work-stealing deque (Chase-Lev)
+//
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+#include <vector>
+
+namespace ucxx {
+
+/**
+ * @brief Chase-Lev work-stealing deque of pointers.
+ * The owner thread pushes and takes items at the bottom (LIFO), any other
+ * thread may steal items from the top (FIFO). Only the owner may call
+ * push() and take(), steal() is safe from any thread.
+ * The item array grows as needed and never shrinks. Arrays replaced by
+ * growing are kept until the deque is destroyed, as a concurrent thief
+ * may still be reading from them.
+ * Memory orderings follow "Correct and Efficient Work-Stealing for Weak
+ * Memory Models" (Le, Pop, Cohen, Zappa Nardelli, 2013).
+ */
+template <typename T>
+class WorkStealingDeque
+{
+public:
+
+    /**
+     * @brief Construct an empty deque.
+     * @param capacity Initial capacity, rounded up to a power of two.
+     */
+    WorkStealingDeque(size_t capacity = 256)
+        : m_top(0), m_bottom(0)
+    {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        m_arrays.push_back(new Array(size));
+        m_array.store(m_arrays.back(), std::memory_order_relaxed);
+    }
+
+    ~WorkStealingDeque()
+    {
+        for (size_t i = 0; i < m_arrays.size(); i++) {
+            delete m_arrays[i];
+        }
+    }
+
+    /**
+     * @brief Owner: push an item to the bottom.
+     */
+    void push(T *pItem)
+    {
+        int64_t b = m_bottom.load(std::memory_order_relaxed);
+        int64_t t = m_top.load(std::memory_order_acquire);
+        Array *pArray = m_array.load(std::memory_order_relaxed);
+        if (b - t > static_cast<int64_t>(pArray->mask)) {
+            pArray = grow(pArray, t, b);
+        }
+        pArray->put(b, pItem);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Owner: take the most recently pushed item.
+     * @return Item or null if the deque is empty.
+     */
+    T* take()
+    {
+        int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+        Array *pArray = m_array.load(std::memory_order_relaxed);
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = m_top.load(std::memory_order_relaxed);
+
+        T *pItem = 0;
+        if (t <= b) {
+            pItem = pArray->get(b);
+            if (t == b) {
+                // Last item, race against thieves
+                if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    pItem = 0;
+                }
+                m_bottom.store(b + 1, std::memory_order_relaxed);
+            }
+        } else {
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return pItem;
+    }
+
+    /**
+     * @brief Any thread: take the least recently pushed item.
+     * @return Item or null if the deque is empty or another thread won the item.
+     */
+    T* steal()
+    {
+        int64_t t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = m_bottom.load(std::memory_order_acquire);
+
+        if (t >= b) {
+            return 0;
+        }
+        Array *pArray = m_array.load(std::memory_order_acquire);
+        T *pItem = pArray->get(t);
+        if (!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return 0;
+        }
+        return pItem;
+    }
+
+    /**
+     * @brief Returns approximate number of items.
+     */
+    size_t size() const
+    {
+        int64_t b = m_bottom.load(std::memory_order_relaxed);
+        int64_t t = m_top.load(std::memory_order_relaxed);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+
+private:
+
+    // Disable copying
+    WorkStealingDeque(const WorkStealingDeque&);
+    WorkStealingDeque& operator =(const WorkStealingDeque&);
+
+    /// Circular item array.
+    struct Array {
+        size_t mask;
+        std::atomic<T*> *pItems;
+
+        Array(size_t size) : mask(size - 1), pItems(new std::atomic<T*>[size]) {}
+        ~Array() { delete[] pItems; }
+
+        T* get(int64_t i) const { return pItems[i & mask].load(std::memory_order_relaxed); }
+        void put(int64_t i, T *pItem) { pItems[i & mask].store(pItem, std::memory_order_relaxed); }
+    };
+
+    Array* grow(Array *pArray, int64_t top, int64_t bottom)
+    {
+        Array *pGrown = new Array((pArray->mask + 1) * 2);
+        for (int64_t i = top; i < bottom; i++) {
+            pGrown->put(i, pArray->get(i));
+        }
+        m_arrays.push_back(pGrown);
+        m_array.store(pGrown, std::memory_order_release);
+        return pGrown;
+    }
+
+    // Top and bottom are written by different threads, keep them apart
+    std::atomic<int64_t> m_top;     ///< Index of the oldest item, advanced by thieves.
+    char m_padding[64];
+    std::atomic<int64_t> m_bottom;  ///< Index past the newest item, owned by the owner.
+    std::atomic<Array*> m_array;    ///< Current item array.
+    std::vector<Array*> m_arrays;   ///< All arrays ever allocated (owner only).
+};
+
+} // namespace ucxx
+
+#endif // UCXX_WORKSTEALINGDEQUE_H
@@ -0,0 +1,84 @@
+#ifndef UCXX_BENCH_H
+#define UCXX_BENCH_H
+
+//
+// Helpers shared by the benchmarks
+//
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <functional>
+#include <vector>
+#include "Thread.h"
+#include "Clock.h"
+
+namespace ucxx {
+namespace bench {
+
+/**
+ * @brief Thread running a function with its index.
+ */
+class Worker : public IRunnable
+{
+public:
+    Worker(const std::function<void(unsigned)> &function, unsigned index)
+        : m_function(function), m_index(index), m_thread(this) {}
+
+    void run() { m_function(m_index); }
+
+    bool start() { return m_thread.start(); }
+    void join() { m_thread.join(); }
+
+private:
+
+    // Disable copying
+    Worker(const Worker&);
+    Worker& operator =(const Worker&);
+
+    std::function<void(unsigned)> m_function;
+    unsigned m_index;
+    Thread m_thread;
+};
+
+/**
+ * @brief Run a function on given number of threads at once.
+ * The process exits if a thread cannot be started, as the threads already
+ * running would wait for their peers forever.
+ * @param threadCount Number of threads, the function gets indexes
+ * 0 to threadCount - 1.
+ * @return Elapsed time in microseconds.
+ */
+inline uint64_t runThreads(unsigned threadCount, const std::function<void(unsigned)> &function)
+{
+    std::vector<Worker*> workers;
+    for (unsigned i = 0; i < threadCount; i++) {
+        workers.push_back(new Worker(function, i));
+    }
+    uint64_t start = Clock::microseconds();
+    for (size_t i = 0; i < workers.size(); i++) {
+        if (!workers[i]->start()) {
+            fprintf(stderr, "Cannot start %u threads\n", threadCount);
+            exit(1);
+        }
+    }
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i]->join();
+        delete workers[i];
+    }
+    uint64_t elapsed = Clock::microseconds() - start;
+    return elapsed > 0 ? elapsed : 1;
+}
+
+/**
+ * @brief Returns operations per second.
+ */
+inline double rate(uint64_t count, uint64_t microseconds)
+{
+    return microseconds > 0 ? count * 1e6 / microseconds : 0;
+}
+
+} // namespace bench
+} // namespace ucxx
+
+#endif // UCXX_BENCH_H
@@ -0,0 +1,82 @@
+//
+// Throughput of MpmcQueue against the mutex based Queue
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "MpmcQueue.h"
+#include "Queue.h"
+#include "Bench.h"
+
+using namespace ucxx;
+using namespace ucxx::bench;
+
+namespace {
+
+const size_t Capacity = 1024;
+
+// Adapters giving both queues the same blocking interface
+struct LockFree
+{
+    MpmcQueue<int> queue;
+    LockFree() : queue(Capacity) {}
+    void enqueue(int i) { queue.enqueue(i); }
+    int dequeue() { return queue.dequeue(); }
+};
+
+struct Locked
+{
+    Queue<int> queue;
+    Locked() { queue.setCapacity(Capacity); }
+    void enqueue(int i) { queue.enqueue(i); }
+    int dequeue() { return queue.dequeue(); }
+};
+
+/*
+ * Half of the threads produce and half consume, each moving an equal share
+ * of the items; a single thread enqueues and dequeues alternately.
+ */
+template <typename Q>
+double run(unsigned threadCount, unsigned itemCount)
+{
+    Q q;
+    if (threadCount == 1) {
+        uint64_t start = Clock::microseconds();
+        for (unsigned i = 0; i < itemCount; i++) {
+            q.enqueue(i);
+            q.dequeue();
+        }
+        return rate(itemCount, Clock::microseconds() - start);
+    }
+
+    unsigned pairs = threadCount / 2;
+    unsigned share = itemCount / pairs;
+    uint64_t elapsed = runThreads(pairs * 2, [&q, pairs, share](unsigned index) {
+        if (index < pairs) {
+            for (unsigned i = 0; i < share; i++) {
+                q.enqueue(i);
+            }
+        } else {
+            for (unsigned i = 0; i < share; i++) {
+                q.dequeue();
+            }
+        }
+    });
+    return rate(static_cast<uint64_t>(share) * pairs, elapsed);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    unsigned itemCount = argc > 1 ? atoi(argv[1]) : 1000000;
+
+    printf("%u items, capacity %u, items/s\n", itemCount, static_cast<unsigned>(Capacity));
+    printf("%8s %14s %14s\n", "threads", "MpmcQueue", "Queue");
+    for (unsigned threadCount = 1; threadCount <= 32; threadCount *= 2) {
+        double lockFree = run<LockFree>(threadCount, itemCount);
+        double locked = run<Locked>(threadCount, itemCount);
+        printf("%8u %14.0f %14.0f\n", threadCount, lockFree, locked);
+    }
+    return 0;
+}
@@ -0,0 +1,111 @@
+//
+// Semaphore against a semaphore built on sem_t, as before the futex
+// implementation
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <semaphore.h>
+#include "Sema.h"
+#include "Bench.h"
+
+using namespace ucxx;
+using namespace ucxx::bench;
+
+namespace {
+
+// The former POSIX implementation, waiting forever only
+class PosixSemaphore
+{
+public:
+    PosixSemaphore(int value = 0) { sem_init(&m_semaphore, 0, value); }
+    ~PosixSemaphore() { sem_destroy(&m_semaphore); }
+
+    bool wait()
+    {
+        int s;
+        while ((s = sem_wait(&m_semaphore)) == -1 && errno == EINTR) {
+            continue;
+        }
+        return s == 0;
+    }
+
+    void notify() { sem_post(&m_semaphore); }
+
+private:
+
+    // Disable copying
+    PosixSemaphore(const PosixSemaphore&);
+    PosixSemaphore& operator =(const PosixSemaphore&);
+
+    sem_t m_semaphore;
+};
+
+// Notify and wait in a single thread, the counter never reaches zero
+template <typename S>
+double uncontended(unsigned count)
+{
+    S s;
+    uint64_t start = Clock::microseconds();
+    for (unsigned i = 0; i < count; i++) {
+        s.notify();
+        s.wait();
+    }
+    return rate(count, Clock::microseconds() - start);
+}
+
+// Two threads waking each other in turn, every wait blocks
+template <typename S>
+double pingPong(unsigned count)
+{
+    S ping, pong;
+    uint64_t elapsed = runThreads(2, [&ping, &pong, count](unsigned index) {
+        for (unsigned i = 0; i < count; i++) {
+            if (index == 0) {
+                ping.notify();
+                pong.wait();
+            } else {
+                ping.wait();
+                pong.notify();
+            }
+        }
+    });
+    return rate(count, elapsed);
+}
+
+// Threads passing a single token, the semaphore guarding a resource
+template <typename S>
+double token(unsigned threadCount, unsigned count)
+{
+    S s(1);
+    unsigned share = count / threadCount;
+    uint64_t elapsed = runThreads(threadCount, [&s, share](unsigned) {
+        for (unsigned i = 0; i < share; i++) {
+            s.wait();
+            s.notify();
+        }
+    });
+    return rate(static_cast<uint64_t>(share) * threadCount, elapsed);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    unsigned count = argc > 1 ? atoi(argv[1]) : 1000000;
+
+    printf("%u operations, operations/s\n", count);
+    printf("%-14s %14s %14s\n", "", "Semaphore", "sem_t");
+    printf("%-14s %14.0f %14.0f\n", "uncontended",
+           uncontended<Semaphore>(count), uncontended<PosixSemaphore>(count));
+    printf("%-14s %14.0f %14.0f\n", "ping-pong",
+           pingPong<Semaphore>(count / 10), pingPong<PosixSemaphore>(count / 10));
+    for (unsigned threadCount = 1; threadCount <= 32; threadCount *= 2) {
+        char name[32];
+        snprintf(name, sizeof(name), "token %u", threadCount);
+        printf("%-14s %14.0f %14.0f\n", name,
+               token<Semaphore>(threadCount, count), token<PosixSemaphore>(threadCount, count));
+    }
+    return 0;
+}
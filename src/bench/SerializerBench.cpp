@@ -0,0 +1,174 @@
+//
+// Throughput of MsgPackSerializer against ByteArraySerializer, and of the
+// raw value access of ByteArraySerializer against its former version
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "Endian.h"
+#include "ByteArraySerializer.h"
+#include "MsgPackSerializer.h"
+#include "Bench.h"
+
+using namespace ucxx;
+using namespace ucxx::bench;
+
+namespace {
+
+// Record resembling a typical message: scalars, a string and a short list
+Variant makeRecord(int i)
+{
+    VariantList samples;
+    for (int j = 0; j < 8; j++) {
+        samples.push_back(Variant(i * 8 + j));
+    }
+
+    VariantMap record;
+    record["id"] = Variant(i);
+    record["name"] = Variant("record");
+    record["value"] = Variant(i * 0.5);
+    record["valid"] = Variant(i % 2 == 0);
+    record["samples"] = Variant(samples);
+    return Variant(record);
+}
+
+template <typename S>
+void run(const char *pName, const Variant &batch, unsigned recordCount, unsigned rounds)
+{
+    // Encoding
+    size_t size = 0;
+    uint64_t start = Clock::microseconds();
+    for (unsigned i = 0; i < rounds; i++) {
+        S s;
+        s.pushValue(batch);
+        size = s.byteArray().size();
+    }
+    uint64_t encodeTime = Clock::microseconds() - start;
+
+    // Decoding the same encoded data
+    S encoded;
+    encoded.pushValue(batch);
+    Variant decoded;
+    start = Clock::microseconds();
+    for (unsigned i = 0; i < rounds; i++) {
+        S s(encoded.byteArray());
+        if (!s.popValue(decoded)) {
+            fprintf(stderr, "%s: decoding failed\n", pName);
+            exit(1);
+        }
+    }
+    uint64_t decodeTime = Clock::microseconds() - start;
+
+    // Records per second compare the serializers on the same data, MB/s
+    // also depend on how compact the encoding is
+    uint64_t records = static_cast<uint64_t>(recordCount) * rounds;
+    uint64_t bytes = static_cast<uint64_t>(size) * rounds;
+    printf("%-20s %8u bytes  encode %7.0f k/s %7.1f MB/s  decode %7.0f k/s %7.1f MB/s\n",
+           pName, static_cast<unsigned>(size),
+           rate(records, encodeTime) / 1e3, rate(bytes, encodeTime) / 1e6,
+           rate(records, decodeTime) / 1e3, rate(bytes, decodeTime) / 1e6);
+}
+
+/*
+ * Raw values as ByteArraySerializer writes them, each preceded by its
+ * signature byte, so most of them sit at unaligned offsets. The former
+ * version accessed them through a cast pointer in host byte order, the
+ * current one copies them in little-endian order (see Endian.h).
+ */
+
+struct CastAccess
+{
+    template <typename T>
+    static void push(T value, ByteArray &byteArray)
+    {
+        char buffer[sizeof(T)];
+        *reinterpret_cast<T*>(buffer) = value;
+        byteArray.append(buffer, sizeof(T));
+    }
+
+    template <typename T>
+    static T pop(const char *pData)
+    {
+        return *reinterpret_cast<const T*>(pData);
+    }
+};
+
+struct EndianAccess
+{
+    template <typename T>
+    static void push(T value, ByteArray &byteArray)
+    {
+        char buffer[sizeof(T)];
+        storeLittleEndian<T>(buffer, value);
+        byteArray.append(buffer, sizeof(T));
+    }
+
+    template <typename T>
+    static T pop(const char *pData)
+    {
+        return loadLittleEndian<T>(pData);
+    }
+};
+
+volatile double g_sink;
+
+template <typename A>
+void runRaw(const char *pName, unsigned valueCount, unsigned rounds)
+{
+    ByteArray ba;
+    uint64_t start = Clock::microseconds();
+    for (unsigned r = 0; r < rounds; r++) {
+        ba.clear();
+        for (unsigned i = 0; i < valueCount; i++) {
+            ba.append('i');
+            A::push(static_cast<int>(i), ba);
+            ba.append('d');
+            A::push(i * 0.5, ba);
+            ba.append('b');
+            A::push(i % 2 == 0, ba);
+        }
+    }
+    uint64_t encodeTime = Clock::microseconds() - start;
+
+    // The sum keeps the loads from being optimized out
+    double sum = 0;
+    start = Clock::microseconds();
+    for (unsigned r = 0; r < rounds; r++) {
+        const char *pData = ba.constData();
+        for (unsigned i = 0; i < valueCount; i++) {
+            sum += A::template pop<int>(pData + 1);
+            sum += A::template pop<double>(pData + 1 + sizeof(int) + 1);
+            sum += A::template pop<bool>(pData + 1 + sizeof(int) + 1 + sizeof(double) + 1);
+            pData += 3 + sizeof(int) + sizeof(double) + sizeof(bool);
+        }
+    }
+    uint64_t decodeTime = Clock::microseconds() - start;
+    g_sink = sum;
+
+    uint64_t values = static_cast<uint64_t>(valueCount) * 3 * rounds;
+    printf("%-20s encode %7.1f M/s  decode %7.1f M/s\n", pName,
+           rate(values, encodeTime) / 1e6, rate(values, decodeTime) / 1e6);
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    unsigned recordCount = argc > 1 ? atoi(argv[1]) : 1000;
+    unsigned rounds = argc > 2 ? atoi(argv[2]) : 200;
+
+    VariantList records;
+    for (unsigned i = 0; i < recordCount; i++) {
+        records.push_back(makeRecord(i));
+    }
+    Variant batch(records);
+
+    printf("%u records, %u rounds\n", recordCount, rounds);
+    run<ByteArraySerializer>("ByteArraySerializer", batch, recordCount, rounds);
+    run<MsgPackSerializer>("MsgPackSerializer", batch, recordCount, rounds);
+
+    printf("\nRaw values, %u rounds\n", rounds);
+    runRaw<CastAccess>("Cast (former)", recordCount * 100, rounds);
+    runRaw<EndianAccess>("Endian.h", recordCount * 100, rounds);
+    return 0;
+}